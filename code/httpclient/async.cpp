@@ -0,0 +1,101 @@
+// Copyright hopkiw 2026
+#include "async.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace http {
+
+AsyncClient::FetchOp AsyncClient::Fetch(const Request& request, BodySink* sink, std::chrono::milliseconds timeout,
+                                        std::stop_token stop) {
+    return FetchOp(this, request, sink, timeout, std::move(stop));
+}
+
+AsyncClient::SleepOp AsyncClient::Sleep(std::chrono::milliseconds duration) {
+    return SleepOp(this, duration);
+}
+
+void AsyncClient::Spawn(Task<> task) {
+    ++running_;
+    Launch(std::move(task));
+}
+
+AsyncClient::Detached AsyncClient::Launch(Task<> task) {
+    co_await task;
+    --running_;
+}
+
+bool AsyncClient::Run() {
+    while (running_ > 0) {
+        FireTimers();
+        while (!ready_.empty()) {
+            std::coroutine_handle<> h = ready_.front();
+            ready_.pop_front();
+            h.resume();
+        }
+        if (running_ == 0)
+            break;
+
+        // Wait for the network, but no longer than the next timer.
+        auto wait = std::chrono::milliseconds(1000);
+        if (!timers_.empty()) {
+            auto until = std::chrono::ceil<std::chrono::milliseconds>(timers_.begin()->first - Clock::now());
+            wait = std::clamp(until, std::chrono::milliseconds(0), wait);
+        }
+        if (fetcher_.Pending()) {
+            if (!fetcher_.Poll(wait))
+                return false;
+        } else if (!timers_.empty()) {
+            std::this_thread::sleep_for(wait);
+        } else if (ready_.empty()) {
+            // Left waiting on nothing; Running says how many.
+            return false;
+        }
+    }
+    return true;
+}
+
+void AsyncClient::FireTimers() {
+    auto now = Clock::now();
+    while (!timers_.empty() && timers_.begin()->first <= now) {
+        std::function<void()> fire = std::move(timers_.begin()->second);
+        timers_.erase(timers_.begin());
+        fire();
+    }
+}
+
+void AsyncClient::FetchOp::await_suspend(std::coroutine_handle<> h) {
+    handle_ = h;
+    if (stop_.stop_requested()) {
+        result_.error = "cancelled";
+        done_ = true;
+        client_->Resume(h);
+        return;
+    }
+    id_ = client_->fetcher_.Add(request_, sink_ ? sink_ : &discard_, [this](const FetchResult& r) { Done(r); });
+    if (timeout_.count() > 0) {
+        timer_ = client_->timers_.emplace(Clock::now() + timeout_, [this] {
+            timer_.reset();
+            Cancel("timed out");
+        });
+    }
+    if (stop_.stop_possible())
+        on_stop_.emplace(stop_, StopFetch{this});
+}
+
+void AsyncClient::FetchOp::Cancel(const std::string& error) {
+    if (!done_)
+        client_->fetcher_.Cancel(id_, error);
+}
+
+void AsyncClient::FetchOp::Done(const FetchResult& result) {
+    done_ = true;
+    result_ = result;
+    if (timer_) {
+        client_->timers_.erase(*timer_);
+        timer_.reset();
+    }
+    client_->Resume(handle_);
+}
+
+}  // namespace http
@@ -0,0 +1,226 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_ASYNC_H_
+#define CODE_HTTPCLIENT_ASYNC_H_
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <optional>
+#include <stop_token>
+#include <utility>
+
+#include "fetcher.h"
+#include "message.h"
+#include "sink.h"
+
+namespace http {
+
+template <typename T = void>
+class Task;
+
+namespace internal {
+
+// Resumes whoever co_awaited the task once it has finished.
+struct FinalAwaiter {
+  bool await_ready() noexcept { return false; }
+  template <typename Promise>
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+      std::coroutine_handle<> next = h.promise().continuation;
+      return next ? next : std::noop_coroutine();
+  }
+  void await_resume() noexcept {}
+};
+
+struct PromiseBase {
+  std::coroutine_handle<> continuation;
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  FinalAwaiter final_suspend() noexcept { return {}; }
+  // Nothing here throws; a stray exception is a bug.
+  void unhandled_exception() { std::terminate(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+  std::optional<T> value;
+
+  Task<T> get_return_object();
+  void return_value(T v) { value = std::move(v); }
+  T Result() { return std::move(*value); }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+  Task<void> get_return_object();
+  void return_void() {}
+  void Result() {}
+};
+
+}  // namespace internal
+
+// A coroutine returning T. It starts when first co_awaited (or when handed
+// to AsyncClient::Spawn), and the awaiting coroutine carries on when it
+// co_returns.
+template <typename T>
+class Task {
+ public:
+  typedef internal::Promise<T> promise_type;
+
+  explicit Task(std::coroutine_handle<promise_type> h) : handle_{h} {}
+  Task(Task&& other) : handle_{std::exchange(other.handle_, nullptr)} {}
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+  ~Task() {
+    if (handle_)
+        handle_.destroy();
+  }
+
+  bool await_ready() const { return false; }
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) {
+      handle_.promise().continuation = awaiting;
+      return handle_;
+  }
+  T await_resume() { return handle_.promise().Result(); }
+
+ private:
+  std::coroutine_handle<promise_type> handle_;
+};
+
+namespace internal {
+
+template <typename T>
+Task<T> Promise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+}  // namespace internal
+
+// Coroutines on top of a Fetcher, all on the calling thread:
+//
+//   Task<> Get(AsyncClient* client, Request request) {
+//       MemorySink body;
+//       FetchResult result = co_await client->Fetch(request, &body);
+//       ...
+//   }
+//
+//   client.Spawn(Get(&client, request));
+//   client.Run();
+//
+// Run turns the Fetcher's event loop and resumes each coroutine once what
+// it awaits is done, so thousands of requests can be in flight without a
+// thread apiece. A fetch ends early if its timeout passes or its stop
+// token is triggered; the result's error then says which. Nothing here is
+// thread-safe, and a stop callback runs on whichever thread requests the
+// stop, so request it from the thread calling Run, e.g. from another task.
+class AsyncClient {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  class FetchOp;
+  class SleepOp;
+
+  AsyncClient(size_t max_total, size_t max_per_host) : fetcher_{max_total, max_per_host} {}
+  AsyncClient(const AsyncClient&) = delete;
+  AsyncClient& operator=(const AsyncClient&) = delete;
+
+  // co_await gives the FetchResult. The request is copied, so the op can
+  // outlive it; the body goes to sink, or nowhere if it is null. A zero
+  // timeout means only the Fetcher's idle timeout applies.
+  FetchOp Fetch(const Request& request, BodySink* sink = nullptr,
+                std::chrono::milliseconds timeout = std::chrono::milliseconds(0), std::stop_token stop = {});
+  SleepOp Sleep(std::chrono::milliseconds duration);
+
+  // Starts task, which runs until its first co_await before Spawn returns.
+  void Spawn(Task<> task);
+  // Runs until every spawned task has finished. Returns false if the event
+  // loop fails, or if tasks are left waiting on something that will never
+  // happen.
+  bool Run();
+  // Spawned tasks that haven't finished.
+  size_t Running() const { return running_; }
+
+  Fetcher& Backend() { return fetcher_; }
+
+ private:
+  typedef std::multimap<Clock::time_point, std::function<void()>> Timers;
+
+  // The frame Spawn runs a task in; it frees itself at the end.
+  struct Detached {
+    struct promise_type {
+      Detached get_return_object() { return {}; }
+      std::suspend_never initial_suspend() noexcept { return {}; }
+      std::suspend_never final_suspend() noexcept { return {}; }
+      void return_void() {}
+      void unhandled_exception() { std::terminate(); }
+    };
+  };
+
+  Detached Launch(Task<> task);
+  void Resume(std::coroutine_handle<> h) { ready_.push_back(h); }
+  void FireTimers();
+
+  Fetcher fetcher_;
+  Timers timers_;
+  std::deque<std::coroutine_handle<>> ready_;
+  size_t running_ = 0;
+};
+
+class AsyncClient::FetchOp {
+ public:
+  FetchOp(AsyncClient* client, Request request, BodySink* sink, std::chrono::milliseconds timeout,
+          std::stop_token stop)
+      : client_{client}, request_{std::move(request)}, sink_{sink}, timeout_{timeout}, stop_{std::move(stop)} {}
+
+  bool await_ready() const { return false; }
+  void await_suspend(std::coroutine_handle<> h);
+  FetchResult await_resume() { return std::move(result_); }
+
+ private:
+  struct StopFetch {
+    FetchOp* op;
+    void operator()() { op->Cancel("cancelled"); }
+  };
+
+  void Cancel(const std::string& error);
+  void Done(const FetchResult&);
+
+  AsyncClient* client_;
+  Request request_;
+  BodySink* sink_;
+  std::chrono::milliseconds timeout_;
+  std::stop_token stop_;
+  DiscardSink discard_;
+  std::coroutine_handle<> handle_;
+  uint64_t id_ = 0;
+  bool done_ = false;
+  std::optional<Timers::iterator> timer_;
+  std::optional<std::stop_callback<StopFetch>> on_stop_;
+  FetchResult result_;
+};
+
+class AsyncClient::SleepOp {
+ public:
+  SleepOp(AsyncClient* client, std::chrono::milliseconds duration) : client_{client}, duration_{duration} {}
+
+  bool await_ready() const { return duration_.count() <= 0; }
+  void await_suspend(std::coroutine_handle<> h) {
+      client_->timers_.emplace(Clock::now() + duration_, [client = client_, h] { client->Resume(h); });
+  }
+  void await_resume() {}
+
+ private:
+  AsyncClient* client_;
+  std::chrono::milliseconds duration_;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_ASYNC_H_
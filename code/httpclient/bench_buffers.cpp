@@ -0,0 +1,108 @@
+// Copyright hopkiw 2026
+//
+// Reads a large body from the loopback server the way Client::ReadResponse
+// used to (a 1 KiB stack buffer, cleared before every recv) and with
+// pooled buffers of each size, and reports recv calls per MB and
+// throughput for each. Then runs chunked downloads through the Client to
+// show the pool handing the same buffer back each time.
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "buffer.h"
+#include "client.h"
+#include "loopback.h"
+#include "message.h"
+#include "sink.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+constexpr int64_t kBody = 64 * 1024 * 1024;
+
+int Connect(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd == -1 || connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+        std::cout << "Failed to connect to the loopback server" << std::endl;
+        exit(1);
+    }
+    return fd;
+}
+
+// Asks for the body with Connection: close and reads until the server
+// hangs up, calling read for every recv.
+void Run(const std::string& name, int port, const std::function<ssize_t(int)>& read) {
+    int fd = Connect(port);
+    std::string request = "GET /" + std::to_string(kBody) + "-x HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    send(fd, request.data(), request.length(), 0);
+
+    uint64_t calls = 0, bytes = 0;
+    auto start = Clock::now();
+    ssize_t n;
+    while ((n = read(fd)) > 0) {
+        ++calls;
+        bytes += n;
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    close(fd);
+
+    double mb = bytes / (1024.0 * 1024.0);
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << calls / mb << std::setw(10) << mb / seconds << std::endl;
+}
+
+}  // namespace
+
+int main() {
+    http::LoopbackServer server;
+    if (!server.Start())
+        return 1;
+    int port = server.Port();
+
+    std::cout << std::left << std::setw(20) << "buffer" << std::right << std::setw(12) << "recvs/MB"
+              << std::setw(10) << "MB/s" << std::endl;
+    Run("1 KiB + memset", port, [](int fd) {
+        char buf[1024];
+        memset(buf, 0, 1024);
+        return recv(fd, buf, 1024, 0);
+    });
+    for (size_t size = http::BufferPool::kMinSize; size <= http::BufferPool::kMaxSize; size *= 2) {
+        http::Buffer buf = http::BufferPool::Default().Get(size);
+        Run("pooled " + std::to_string(size / 1024) + " KiB", port,
+            [&](int fd) { return recv(fd, buf.Data(), buf.Capacity(), 0); });
+    }
+
+    // Chunked bodies can't be spliced, so they all go through the buffer.
+    http::Client client;
+    http::DiscardSink sink;
+    http::Request request(http::URI::Parse("http://127.0.0.1:" + std::to_string(port) + "/" +
+                                           std::to_string(kBody / 4) + "-c"));
+    auto start = Clock::now();
+    const int kRounds = 8;
+    for (int i = 0; i < kRounds; ++i)
+        client.Do(request, &sink);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    const http::BufferPool& pool = http::BufferPool::Default();
+    std::cout << std::fixed << std::setprecision(1) << "Client, chunked: " << sink.Bytes() / (1024.0 * 1024.0) / seconds
+              << " MB/s; pool handed out " << pool.Gets() << " buffers, " << pool.Reused() << " reused, from "
+              << pool.Slabs() << " slabs" << std::endl;
+
+    server.Stop();
+    return 0;
+}
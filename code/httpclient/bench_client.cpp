@@ -0,0 +1,239 @@
+// Copyright hopkiw 2026
+//
+// Load-tests the client against the loopback server: small objects one at
+// a time and pipelined, large bodies with and without chunking, resumable
+// downloads with compression on, many concurrent connections through the
+// Fetcher, the same from coroutines, and a slow server. Reports requests
+// per second, throughput and latency percentiles for each.
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "async.h"
+#include "client.h"
+#include "fetcher.h"
+#include "loopback.h"
+#include "message.h"
+#include "sink.h"
+#include "timing.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Result {
+  std::string name;
+  uint64_t requests = 0;
+  uint64_t failed = 0;
+  uint64_t bytes = 0;
+  double seconds = 0;
+};
+
+std::set<std::string> written;
+
+// The client reports every file it writes on std::cout; keep that out of
+// the table while a scenario runs.
+class Quiet {
+ public:
+  Quiet() : saved_{std::cout.rdbuf(nullptr)} {}
+  ~Quiet() { std::cout.rdbuf(saved_); }
+
+ private:
+  std::streambuf* saved_;
+};
+
+http::Request Get(int port, const std::string& path) {
+    written.insert(path.substr(1));
+    return http::Request(http::URI::Parse("http://127.0.0.1:" + std::to_string(port) + path));
+}
+
+void Print(const Result& result, const http::PhaseHistograms& histograms) {
+    const http::Histogram& total = histograms.Get(http::kTotal);
+    auto us = [&](double p) { return total.Percentile(p) / 1000.0; };
+    std::cout << std::left << std::setw(16) << result.name << std::right << std::setw(8) << result.requests
+              << std::setw(7) << result.failed << std::fixed << std::setprecision(0)
+              << std::setw(10) << result.requests / result.seconds << std::setprecision(1)
+              << std::setw(10) << result.bytes / result.seconds / (1024 * 1024)
+              << std::setw(10) << us(0.5) << std::setw(10) << us(0.99) << std::setw(10) << us(0.999) << std::endl;
+}
+
+// One request after another through Client::Do.
+void Sequential(const std::string& name, int port, const std::string& path, int count) {
+    http::Client client;
+    Result result;
+    result.name = name;
+    auto start = Clock::now();
+    {
+        Quiet quiet;
+        for (int i = 0; i < count; ++i) {
+            http::Response res = client.Do(Get(port, path));
+            ++result.requests;
+            if (res.StatusCode() != 200)
+                ++result.failed;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.bytes = client.Stats().Bytes();
+    Print(result, client.Histograms());
+}
+
+// Downloads to a file in the scratch directory with resuming and
+// compression both on. Since the file might be resumed, the body must come
+// unencoded; a file that isn't size bytes long counts as failed.
+void ResumeCompressed(const std::string& name, int port, int64_t size, int count) {
+    http::Client client;
+    client.SetResume(true);
+    client.SetCompression(true);
+    std::string path = "/" + std::to_string(size) + "-g";
+    Result result;
+    result.name = name;
+    auto start = Clock::now();
+    {
+        Quiet quiet;
+        for (int i = 0; i < count; ++i) {
+            http::Response res = client.Do(Get(port, path));
+            ++result.requests;
+            struct stat st;
+            if (res.StatusCode() != 200 || stat(path.c_str() + 1, &st) == -1 || st.st_size != size)
+                ++result.failed;
+            // Start the next one from nothing, and leave nothing behind.
+            unlink(path.c_str() + 1);
+            unlink((path.substr(1) + ".resume").c_str());
+        }
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.bytes = client.Stats().Bytes();
+    Print(result, client.Histograms());
+}
+
+// All at once through Client::DoMany on one connection.
+void Pipelined(const std::string& name, int port, const std::string& path, int count) {
+    http::Client client;
+    std::vector<http::Request> requests;
+    for (int i = 0; i < count; ++i)
+        requests.push_back(Get(port, path));
+    Result result;
+    result.name = name;
+    auto start = Clock::now();
+    {
+        Quiet quiet;
+        for (const http::Response& res : client.DoMany(requests)) {
+            ++result.requests;
+            if (res.StatusCode() != 200)
+                ++result.failed;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.bytes = client.Stats().Bytes();
+    Print(result, client.Histograms());
+}
+
+// count requests through the Fetcher, connections at a time.
+void Concurrent(const std::string& name, int port, const std::string& path, int count, size_t connections,
+                bool uring = false) {
+    http::Fetcher fetcher(connections, connections);
+    fetcher.SetUring(uring);
+    // Bodies are thrown away so this measures the client rather than the
+    // disk.
+    http::DiscardSink sink;
+    Result result;
+    result.name = name;
+    for (int i = 0; i < count; ++i) {
+        fetcher.Add(Get(port, path), &sink, [&](const http::FetchResult& fetched) {
+            ++result.requests;
+            result.bytes += fetched.bytes;
+            if (!fetched.OK() || fetched.status != 200)
+                ++result.failed;
+        });
+    }
+    auto start = Clock::now();
+    {
+        Quiet quiet;
+        fetcher.Run();
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    Print(result, fetcher.Histograms());
+}
+
+// Worker does its share of count requests one after another.
+http::Task<> Worker(http::AsyncClient* client, int port, const std::string& path, int count,
+                    std::chrono::milliseconds timeout, Result* result) {
+    for (int i = 0; i < count; ++i) {
+        http::FetchResult fetched = co_await client->Fetch(Get(port, path), nullptr, timeout);
+        ++result->requests;
+        result->bytes += fetched.bytes;
+        if (!fetched.OK() || fetched.status != 200)
+            ++result->failed;
+    }
+}
+
+// count requests from workers coroutines. With a timeout, requests that
+// take longer count as failed.
+void Coroutines(const std::string& name, int port, const std::string& path, int count, int workers,
+                std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) {
+    http::AsyncClient client(workers, workers);
+    Result result;
+    result.name = name;
+    auto start = Clock::now();
+    bool ok;
+    {
+        Quiet quiet;
+        for (int i = 0; i < workers; ++i)
+            client.Spawn(Worker(&client, port, path, count / workers, timeout, &result));
+        ok = client.Run();
+    }
+    if (!ok)
+        std::cout << name << ": " << client.Running() << " tasks never finished" << std::endl;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    Print(result, client.Backend().Histograms());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::max(1, atoi(argv[1])) : 2000;
+
+    // The client saves bodies under the current directory.
+    char dir[] = "/tmp/bench_client.XXXXXX";
+    if (mkdtemp(dir) == NULL || chdir(dir) == -1) {
+        std::cout << "Failed to create a scratch directory" << std::endl;
+        return 1;
+    }
+
+    http::LoopbackServer server;
+    if (!server.Start())
+        return 1;
+    int port = server.Port();
+
+    std::cout << std::left << std::setw(16) << "scenario" << std::right << std::setw(8) << "reqs"
+              << std::setw(7) << "fail" << std::setw(10) << "req/s" << std::setw(10) << "MB/s"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us" << std::endl;
+    Sequential("small", port, "/100", count);
+    Pipelined("small pipelined", port, "/100", count);
+    Sequential("large", port, "/33554432", 8);
+    Sequential("large chunked", port, "/33554432-c", 8);
+    Sequential("small close", port, "/100-x", count / 4);
+    ResumeCompressed("resume + gzip", port, 12000, count / 4);
+    Concurrent("64 conns epoll", port, "/4096", count * 4, 64);
+    Concurrent("64 conns uring", port, "/4096", count * 4, 64, true);
+    Concurrent("16 large epoll", port, "/1048576", 64, 16);
+    Concurrent("16 large uring", port, "/1048576", 64, 16, true);
+    Concurrent("slow server", port, "/4096-d20", count / 4, 64);
+    Coroutines("64 coroutines", port, "/4096", count * 4, 64);
+    Coroutines("timeouts", port, "/4096-d50", 256, 64, std::chrono::milliseconds(10));
+
+    server.Stop();
+    for (const std::string& file : written)
+        unlink(file.c_str());
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Copyright hopkiw 2026
+//
+// Checks every SHA-256 and CRC32C implementation the CPU can run against
+// known answers, then reports how fast each digests a body fed to it in
+// FileSink-sized pieces.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "digest.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+constexpr size_t kBody = 256 * 1024 * 1024;
+constexpr size_t kPiece = 256 * 1024;
+
+// Runs the SHA-256 padding and length encoding over blocks, which is what
+// Sha256::Final does, but with a chosen block function.
+std::string Sha256With(void (*blocks)(uint32_t*, const unsigned char*, size_t), const std::string& data) {
+    uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                         0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    std::string padded = data + '\x80';
+    padded.append((120 - padded.length() % 64) % 64, '\0');
+    uint64_t bits = data.length() * 8;
+    for (int i = 7; i >= 0; --i)
+        padded += static_cast<char>(bits >> (8 * i));
+    blocks(state, reinterpret_cast<const unsigned char*>(padded.data()), padded.length() / 64);
+    char hex[65];
+    for (int i = 0; i < 8; ++i)
+        snprintf(hex + 8 * i, 9, "%08x", state[i]);
+    return hex;
+}
+
+bool Check(const std::string& name, const std::string& got, const std::string& want) {
+    if (got == want)
+        return true;
+    std::cout << name << ": got " << got << ", want " << want << std::endl;
+    return false;
+}
+
+void Time(const std::string& name, const std::vector<char>& body, const std::function<void(const char*, size_t)>& fn) {
+    auto start = Clock::now();
+    for (size_t offset = 0; offset < body.size(); offset += kPiece)
+        fn(body.data() + offset, std::min(kPiece, body.size() - offset));
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << body.size() / (1024.0 * 1024.0) / seconds << " MB/s" << std::endl;
+}
+
+}  // namespace
+
+int main() {
+    bool sha_ni = http::internal::HasShaNi();
+    bool sse42 = http::internal::HasSse42();
+    std::cout << "SHA extensions: " << (sha_ni ? "yes" : "no") << ", SSE4.2: " << (sse42 ? "yes" : "no") << std::endl;
+
+    const std::string kAbc = "abc";
+    const std::string kLong = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    const std::string kCheck = "123456789";
+    bool ok = true;
+    for (int ni = 0; ni <= (sha_ni ? 1 : 0); ++ni) {
+        auto blocks = ni ? http::internal::Sha256BlocksNi : http::internal::Sha256Blocks;
+        std::string name = ni ? "sha256 (SHA-NI)" : "sha256 (portable)";
+        ok &= Check(name, Sha256With(blocks, ""),
+                    "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        ok &= Check(name, Sha256With(blocks, kAbc),
+                    "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        ok &= Check(name, Sha256With(blocks, kLong),
+                    "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    }
+    for (int hw = 0; hw <= (sse42 ? 1 : 0); ++hw) {
+        auto update = hw ? http::internal::Crc32cUpdateSse42 : http::internal::Crc32cUpdate;
+        char hex[9];
+        snprintf(hex, sizeof(hex), "%08x", ~update(0xFFFFFFFF, kCheck.data(), kCheck.length()));
+        ok &= Check(hw ? "crc32c (SSE4.2)" : "crc32c (portable)", hex, "e3069283");
+    }
+
+    // And through the classes, fed a byte at a time.
+    std::string million(1000000, 'a');
+    http::Sha256 sha;
+    http::Crc32c crc;
+    for (char c : million) {
+        sha.Update(&c, 1);
+        crc.Update(&c, 1);
+    }
+    ok &= Check("Sha256", sha.Final(), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    crc.Reset();
+    crc.Update(kCheck.data(), kCheck.length());
+    ok &= Check("Crc32c", crc.Final(), "e3069283");
+    if (!ok)
+        return 1;
+
+    std::vector<char> body(kBody);
+    for (size_t i = 0; i < body.size(); ++i)
+        body[i] = static_cast<char>(i * 2654435761u >> 24);
+    uint32_t state[8] = {};
+    uint32_t value = 0;
+    Time("sha256 portable", body, [&](const char* data, size_t len) {
+        http::internal::Sha256Blocks(state, reinterpret_cast<const unsigned char*>(data), len / 64);
+    });
+    if (sha_ni) {
+        Time("sha256 SHA-NI", body, [&](const char* data, size_t len) {
+            http::internal::Sha256BlocksNi(state, reinterpret_cast<const unsigned char*>(data), len / 64);
+        });
+    }
+    Time("crc32c portable", body, [&](const char* data, size_t len) {
+        value = http::internal::Crc32cUpdate(value, data, len);
+    });
+    if (sse42) {
+        Time("crc32c SSE4.2", body, [&](const char* data, size_t len) {
+            value = http::internal::Crc32cUpdateSse42(value, data, len);
+        });
+    }
+    // Keeps the work from being optimized away.
+    return state[0] == 1 && value == 1 ? 2 : 0;
+}
@@ -0,0 +1,178 @@
+// Copyright hopkiw 2026
+//
+// Compares the string_view head parser with the std::string based
+// Response::ParseHeaders it replaced, on a few realistic response heads.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "headers.h"
+#include "message.h"
+
+namespace {
+
+typedef std::pair<std::string, std::string> Header;
+
+// The parser as it was before ParseHead: find the blank line, copy the head
+// out, then copy every name and value into its own std::string.
+int LegacyParseHeaders(const std::string& headers, std::vector<Header>* headers_) {
+    typedef std::string::const_iterator iterator_t;
+
+    iterator_t status_start = headers.begin();
+    iterator_t status_end = std::find(status_start, headers.end(), '\r');
+    if (status_end == headers.end())
+        return -1;
+    std::string check = &*(status_end);
+    if (check.substr(0, 2) != "\r\n")
+        return -1;
+
+    iterator_t version_start = status_start;
+    iterator_t version_end = std::find(version_start, status_end, ' ');
+    if (version_end == status_end)
+        return -1;
+    std::string ver = std::string(version_start, version_end);
+    if (ver != "HTTP/1.1")
+        return -1;
+
+    iterator_t code_start = version_end + 1;
+    iterator_t code_end = std::find(code_start, status_end, ' ');
+    if (code_end == status_end)
+        return -1;
+    std::string code = std::string(code_start, code_end);
+    if (code.length() == 0)
+        return -1;
+    int status_code = std::stoi(code);
+
+    iterator_t header_start = status_end + 2;
+    for (; ;) {
+        if (header_start == headers.end())
+            break;
+        iterator_t header_end = std::find(header_start, headers.end(), '\n');
+        iterator_t key_start = header_start;
+        iterator_t key_end = std::find(header_start, header_end, ':');
+        if (key_end == header_end)
+            return -1;
+        std::string key(key_start, key_end);
+        std::string value(key_end + 2, header_end - 1);
+        headers_->push_back({key, value});
+        if (header_end == headers.end())
+            break;
+
+        header_start = header_end + 1;
+    }
+    return status_code;
+}
+
+int Legacy(const std::string& wire) {
+    size_t end = wire.find("\r\n\r\n");
+    std::vector<Header> headers;
+    int status = LegacyParseHeaders(wire.substr(0, end + 2), &headers);
+    return status + headers.size();
+}
+
+int Views(const std::string& wire) {
+    http::ResponseHead head;
+    if (http::ParseHead(wire, &head) <= 0)
+        return -1;
+    return head.status + head.nfields;
+}
+
+int Stored(const std::string& wire) {
+    http::Response res;
+    if (res.Parse(wire) <= 0)
+        return -1;
+    return res.StatusCode() + res.ContentLength();
+}
+
+const char kMinimal[] =
+    "HTTP/1.1 204 No Content\r\n"
+    "Date: Sat, 17 Oct 2026 22:24:50 GMT\r\n"
+    "Content-Length: 0\r\n"
+    "\r\n";
+
+const char kStatic[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Server: nginx/1.24.0\r\n"
+    "Date: Sat, 17 Oct 2026 22:24:50 GMT\r\n"
+    "Content-Type: application/octet-stream\r\n"
+    "Content-Length: 734003200\r\n"
+    "Last-Modified: Tue, 13 Oct 2026 08:01:12 GMT\r\n"
+    "Connection: keep-alive\r\n"
+    "ETag: \"6528f4b8-2bc00000\"\r\n"
+    "Cache-Control: public, max-age=86400\r\n"
+    "Expires: Sun, 18 Oct 2026 22:24:50 GMT\r\n"
+    "Accept-Ranges: bytes\r\n"
+    "\r\n";
+
+const char kCdn[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/html; charset=utf-8\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "Connection: keep-alive\r\n"
+    "Date: Sat, 17 Oct 2026 22:24:50 GMT\r\n"
+    "Cache-Control: private, no-cache, no-store, max-age=0, must-revalidate\r\n"
+    "Content-Security-Policy: default-src 'self'; script-src 'self' 'unsafe-inline' https://cdn.example.com "
+    "https://www.googletagmanager.com; img-src * data:; style-src 'self' 'unsafe-inline'; "
+    "frame-ancestors 'none'; upgrade-insecure-requests\r\n"
+    "Strict-Transport-Security: max-age=63072000; includeSubDomains; preload\r\n"
+    "X-Content-Type-Options: nosniff\r\n"
+    "X-Frame-Options: DENY\r\n"
+    "Referrer-Policy: strict-origin-when-cross-origin\r\n"
+    "Set-Cookie: session=8f14e45fceea167a5a36dedd4bea2543; Path=/; Secure; HttpOnly; SameSite=Lax\r\n"
+    "Set-Cookie: csrftoken=c9f0f895fb98ab9159f51fd0297e236d; Path=/; Secure; SameSite=Strict\r\n"
+    "Set-Cookie: _ga=GA1.2.1386411925.1697581490; Domain=.example.com; Expires=Mon, 17 Oct 2027 22:24:50 GMT\r\n"
+    "Vary: Accept-Encoding, Cookie\r\n"
+    "Via: 1.1 varnish, 1.1 b7a3e1d0c4f2.cloudfront.net (CloudFront)\r\n"
+    "X-Cache: Miss from cloudfront\r\n"
+    "X-Amz-Cf-Pop: FRA56-P5\r\n"
+    "X-Amz-Cf-Id: 2QmW6JYx1b0Z4fEwZzF7Xr7lSxXv8GJ3q8kP3A1lN0uT0hC7c4eRgA==\r\n"
+    "Age: 0\r\n"
+    "Alt-Svc: h3=\":443\"; ma=86400\r\n"
+    "Server-Timing: cdn-cache; desc=MISS, edge; dur=12, origin; dur=87\r\n"
+    "X-Request-Id: 7c9e6679-7425-40de-944b-e07fc1f90ae7\r\n"
+    "Report-To: {\"group\":\"default\",\"max_age\":31536000,\"endpoints\":[{\"url\":\"https://r.example.com/a\"}]}\r\n"
+    "NEL: {\"report_to\":\"default\",\"max_age\":31536000,\"include_subdomains\":true}\r\n"
+    "\r\n";
+
+template <typename Fn>
+double Run(const std::string& wire, Fn fn, int iterations) {
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        sink = sink + fn(wire);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::max(1, atoi(argv[1])) : 500000;
+
+    std::vector<std::pair<std::string, std::string>> sets = {
+        {"minimal", kMinimal},
+        {"static", kStatic},
+        {"cdn", kCdn},
+    };
+
+    std::cout << std::left << std::setw(10) << "head" << std::setw(8) << "bytes" << std::right
+              << std::setw(14) << "legacy ns" << std::setw(14) << "views ns" << std::setw(14) << "stored ns"
+              << std::setw(10) << "speedup" << std::endl;
+    for (const auto& set : sets) {
+        const std::string& wire = set.second;
+        double legacy = Run(wire, Legacy, iterations);
+        double views = Run(wire, Views, iterations);
+        double stored = Run(wire, Stored, iterations);
+        std::cout << std::left << std::setw(10) << set.first << std::setw(8) << wire.length() << std::right
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(14) << legacy << std::setw(14) << views << std::setw(14) << stored
+                  << std::setw(9) << legacy / stored << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Copyright hopkiw 2026
+//
+// Compares the string_view URI parser with the std::string based
+// URI::Parse it replaced, on a few kinds of URL found in crawl manifests.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "uri.h"
+
+namespace {
+
+// Checked at compile time.
+constexpr bool Parses(std::string_view uri, std::string_view host, uint16_t port) {
+    http::URIView view;
+    return http::ParseURI(uri, &view) && view.host == host && view.PortNumber() == port;
+}
+static_assert(Parses("http://example.com/", "example.com", 80), "plain");
+static_assert(Parses("https://user:pw@[2001:db8::1]:8443/a?b#c", "2001:db8::1", 8443), "everything");
+static_assert(!Parses("http://example.com:99999/", "example.com", 0), "port out of range");
+
+struct LegacyURI {
+  std::string QueryString, Path, Protocol, Host, Port;
+};
+
+// The parser as it was before ParseURI.
+LegacyURI LegacyParse(const std::string &uri) {
+    LegacyURI result;
+
+    typedef std::string::const_iterator iterator_t;
+
+    if (uri.length() == 0)
+        return result;
+
+    iterator_t uriEnd = uri.end();
+
+    iterator_t queryStart = std::find(uri.begin(), uriEnd, '?');
+
+    iterator_t protocolStart = uri.begin();
+    iterator_t protocolEnd = std::find(protocolStart, uriEnd, ':');
+
+    if (protocolEnd != uriEnd) {
+        std::string prot = &*(protocolEnd);
+        if ((prot.length() > 3) && (prot.substr(0, 3) == "://")) {
+            result.Protocol = std::string(protocolStart, protocolEnd);
+            protocolEnd += 3;
+        } else {
+            protocolEnd = uri.begin();  // no protocol
+        }
+    } else {
+        protocolEnd = uri.begin();  // no protocol
+    }
+
+    iterator_t hostStart = protocolEnd;
+    iterator_t pathStart = std::find(hostStart, uriEnd, '/');
+
+    iterator_t hostEnd = std::find(protocolEnd, (pathStart != uriEnd) ? pathStart : queryStart, ':');
+
+    result.Host = std::string(hostStart, hostEnd);
+
+    if ((hostEnd != uriEnd) && ((&*(hostEnd))[0] == ':')) {
+        ++hostEnd;
+        iterator_t portEnd = (pathStart != uriEnd) ? pathStart : queryStart;
+        result.Port = std::string(hostEnd, portEnd);
+    }
+
+    if (pathStart != uriEnd)
+        result.Path = std::string(pathStart, queryStart);
+
+    if (queryStart != uriEnd)
+        result.QueryString = std::string(queryStart, uri.end());
+
+    return result;
+}
+
+size_t Legacy(const std::string& uri) {
+    LegacyURI parsed = LegacyParse(uri);
+    return parsed.Host.length() + parsed.Path.length();
+}
+
+size_t Owned(const std::string& uri) {
+    http::URI parsed = http::URI::Parse(uri);
+    return parsed.Host.length() + parsed.Path.length();
+}
+
+size_t Views(const std::string& uri) {
+    http::URIView view;
+    if (!http::ParseURI(uri, &view))
+        return 0;
+    return view.host.length() + view.path.length();
+}
+
+template <typename Fn>
+double Run(const std::string& uri, Fn fn, int iterations) {
+    volatile size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        sink = sink + fn(uri);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::max(1, atoi(argv[1])) : 1000000;
+
+    std::vector<std::pair<std::string, std::string>> sets = {
+        {"short", "http://example.com/"},
+        {"port", "http://mirror.example.org:8080/pub/linux/iso/debian-12.5.0-amd64-netinst.iso"},
+        {"query", "https://cdn.example.net/assets/v2/img/hero-banner@2x.webp?w=1920&h=1080&fit=crop&auto=format"
+                  "&q=75&cache=8f14e45fceea167a5a36dedd4bea2543#section-3"},
+        {"ipv6", "http://user:secret@[2001:db8:85a3::8a2e:370:7334]:8443/index.html"},
+    };
+
+    std::cout << std::left << std::setw(8) << "uri" << std::setw(8) << "bytes" << std::right
+              << std::setw(14) << "legacy ns" << std::setw(14) << "owned ns" << std::setw(14) << "views ns"
+              << std::setw(10) << "speedup" << std::endl;
+    for (const auto& set : sets) {
+        const std::string& uri = set.second;
+        double legacy = Run(uri, Legacy, iterations);
+        double owned = Run(uri, Owned, iterations);
+        double views = Run(uri, Views, iterations);
+        std::cout << std::left << std::setw(8) << set.first << std::setw(8) << uri.length() << std::right
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(14) << legacy << std::setw(14) << owned << std::setw(14) << views
+                  << std::setw(9) << legacy / views << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+// Copyright hopkiw 2026
+#include "buffer.h"
+
+#include <utility>
+
+namespace http {
+
+Buffer& Buffer::operator=(Buffer&& other) {
+    std::swap(slot_, other.slot_);
+    return *this;
+}
+
+void Buffer::Release() {
+    if (slot_ != nullptr)
+        slot_->pool->Put(slot_);
+    slot_ = nullptr;
+}
+
+BufferPool& BufferPool::Default() {
+    static BufferPool pool;
+    return pool;
+}
+
+// 0 for 16 KiB and below, up to kClasses - 1 for 256 KiB.
+int BufferPool::Class(size_t size) {
+    int size_class = 0;
+    while (size_class < kClasses - 1 && (kMinSize << size_class) < size)
+        ++size_class;
+    return size_class;
+}
+
+Buffer BufferPool::Get(size_t size) {
+    int size_class = Class(size);
+    gets_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mu_);
+    std::vector<Buffer::Slot*>& free = free_[size_class];
+    if (!free.empty()) {
+        reused_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // new char[] leaves the memory as it is; nothing is cleared.
+        size_t buffer_size = kMinSize << size_class;
+        slabs_.emplace_back(new char[kSlabSize]);
+        char* slab = slabs_.back().get();
+        for (size_t offset = 0; offset + buffer_size <= kSlabSize; offset += buffer_size) {
+            Buffer::Slot& slot = slots_.emplace_back();
+            slot.pool = this;
+            slot.data = slab + offset;
+            slot.size = buffer_size;
+            slot.size_class = size_class;
+            free.push_back(&slot);
+        }
+    }
+    Buffer::Slot* slot = free.back();
+    free.pop_back();
+    return Buffer(slot);
+}
+
+void BufferPool::Put(Buffer::Slot* slot) {
+    std::lock_guard<std::mutex> lock(mu_);
+    free_[slot->size_class].push_back(slot);
+}
+
+size_t BufferPool::Slabs() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return slabs_.size();
+}
+
+}  // namespace http
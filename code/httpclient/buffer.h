@@ -0,0 +1,98 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_BUFFER_H_
+#define CODE_HTTPCLIENT_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace http {
+
+class BufferPool;
+
+// A receive buffer from a BufferPool, which it goes back to when the
+// handle is destroyed. Handles are move-only by design rather than
+// reference counted: the parser and header map copy out what they keep,
+// so no string_view outlives the read it came from, and a count would
+// only add an atomic to every handoff. The contents are never cleared:
+// only what a read has filled is meaningful.
+class Buffer {
+ public:
+  Buffer() {}
+  Buffer(const Buffer&) = delete;
+  Buffer(Buffer&& other) : slot_{other.slot_} { other.slot_ = nullptr; }
+  Buffer& operator=(Buffer&& other);
+  ~Buffer() { Release(); }
+
+  explicit operator bool() const { return slot_ != nullptr; }
+  char* Data() const;
+  size_t Capacity() const;
+  std::string_view View(size_t offset, size_t len) const { return std::string_view(Data() + offset, len); }
+
+ private:
+  friend class BufferPool;
+  struct Slot;
+
+  explicit Buffer(Slot* slot) : slot_{slot} {}
+  void Release();
+
+  Slot* slot_ = nullptr;
+};
+
+// Receive buffers of 16 KiB to 256 KiB in powers of two, carved from 1 MiB
+// slabs so that asking for one is a pop off a free list rather than an
+// allocation. Slabs are kept until the pool goes away. Safe to share
+// between threads.
+class BufferPool {
+ public:
+  static constexpr size_t kMinSize = 16 * 1024;
+  static constexpr size_t kMaxSize = 256 * 1024;
+  static constexpr size_t kSlabSize = 1024 * 1024;
+
+  BufferPool() {}
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  static BufferPool& Default();
+
+  // A buffer of at least size bytes, or of kMaxSize if size is larger.
+  Buffer Get(size_t size);
+
+  size_t Slabs() const;
+  // Buffers handed out, and how many of those came off a free list.
+  uint64_t Gets() const { return gets_.load(std::memory_order_relaxed); }
+  uint64_t Reused() const { return reused_.load(std::memory_order_relaxed); }
+
+ private:
+  friend class Buffer;
+  static constexpr int kClasses = 5;
+
+  static int Class(size_t size);
+  void Put(Buffer::Slot*);
+
+  mutable std::mutex mu_;
+  std::vector<std::unique_ptr<char[]>> slabs_;
+  std::deque<Buffer::Slot> slots_;
+  std::vector<Buffer::Slot*> free_[kClasses];
+  std::atomic<uint64_t> gets_{0};
+  std::atomic<uint64_t> reused_{0};
+};
+
+struct Buffer::Slot {
+  BufferPool* pool;
+  char* data;
+  size_t size;
+  int size_class;
+};
+
+inline char* Buffer::Data() const { return slot_->data; }
+inline size_t Buffer::Capacity() const { return slot_->size; }
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_BUFFER_H_
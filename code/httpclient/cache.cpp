@@ -0,0 +1,429 @@
+// Copyright hopkiw 2026
+#include "cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "headers.h"
+
+namespace http {
+
+namespace {
+
+constexpr char kMagic[8] = {'h', 't', 't', 'p', 'c', 'a', 'c', 'h'};
+constexpr uint32_t kVersion = 2;
+constexpr uint64_t kEmpty = 0;
+constexpr uint64_t kDeleted = 1;
+
+uint64_t HashKey(const std::string& key) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h > kDeleted ? h : h + 2;
+}
+
+// Copies s into a fixed-size field. Returns false if it doesn't fit.
+template <size_t N>
+bool SetField(char (&field)[N], std::string_view s) {
+    if (s.length() >= N)
+        return false;
+    memcpy(field, s.data(), s.length());
+    field[s.length()] = '\0';
+    return true;
+}
+
+// Parses an IMF-fixdate such as "Sun, 06 Nov 1994 08:49:37 GMT". Returns
+// -1 if date is anything else.
+time_t ParseDate(std::string_view date) {
+    std::string s(date);
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    const char* end = strptime(s.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    if (end == NULL || *end != '\0')
+        return -1;
+    return timegm(&tm);
+}
+
+// Finds a directive such as max-age=60 in a Cache-Control value. value
+// gets whatever follows the '=', if anything.
+bool Directive(std::string_view list, std::string_view name, std::string_view* value) {
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view item = list.substr(0, comma);
+        while (!item.empty() && item.front() == ' ')
+            item.remove_prefix(1);
+        while (!item.empty() && item.back() == ' ')
+            item.remove_suffix(1);
+        size_t eq = item.find('=');
+        if (EqualsIgnoreCase(item.substr(0, eq), name)) {
+            if (value)
+                *value = eq == std::string_view::npos ? std::string_view() : item.substr(eq + 1);
+            return true;
+        }
+        if (comma == std::string_view::npos)
+            break;
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+// The request's values of the headers a response's Vary names, a line
+// apiece, which a later request has to match to be answered with it (RFC
+// 9111 section 4.1).
+std::string Varied(std::string_view vary, const HeaderMap& request) {
+    std::string out;
+    while (!vary.empty()) {
+        size_t comma = vary.find(',');
+        std::string_view name = vary.substr(0, comma);
+        while (!name.empty() && name.front() == ' ')
+            name.remove_prefix(1);
+        while (!name.empty() && name.back() == ' ')
+            name.remove_suffix(1);
+        if (!name.empty()) {
+            out.append(name).append(": ");
+            out.append(request.Get(HeaderName(name))).append("\n");
+        }
+        if (comma == std::string_view::npos)
+            break;
+        vary.remove_prefix(comma + 1);
+    }
+    return out;
+}
+
+// When a response received at now stops being fresh (RFC 9111 section
+// 4.2.1): max-age if given, else Expires relative to the server's Date,
+// else a tenth of the time since Last-Modified. no-cache means it has to
+// be revalidated every time.
+time_t Expiry(const HeaderMap& headers, std::string_view cache_control, std::string_view last_modified, time_t now) {
+    std::string_view value;
+    if (Directive(cache_control, "no-cache", NULL))
+        return now;
+    if (Directive(cache_control, "max-age", &value)) {
+        int64_t age = 0;
+        auto result = std::from_chars(value.data(), value.data() + value.length(), age);
+        return result.ec == std::errc() && age > 0 ? now + age : now;
+    }
+
+    time_t date = ParseDate(headers.Get(kDate));
+    if (date == -1)
+        date = now;
+    std::string_view expires = headers.Get(kExpires);
+    if (!expires.empty()) {
+        time_t when = ParseDate(expires);
+        return when > date ? now + (when - date) : now;
+    }
+    time_t modified = ParseDate(last_modified);
+    if (modified != -1 && modified < date)
+        return now + (date - modified) / 10;
+    return now;
+}
+
+}  // namespace
+
+struct DiskCache::Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t slots;
+  int64_t bytes;
+  uint64_t entries;
+  uint64_t tick;
+};
+
+struct DiskCache::Slot {
+  uint64_t hash;  // kEmpty, kDeleted, or the key's hash
+  uint64_t used;  // tick of the last lookup, for LRU
+  int64_t size;
+  int64_t stored;
+  int64_t expires;
+  char url[1024];
+  char etag[256];
+  char last_modified[64];
+  char cache_control[256];
+  char vary[256];    // the response's Vary
+  char varied[512];  // what the request had for those headers
+};
+
+DiskCache::~DiskCache() {
+    if (header_ != nullptr)
+        munmap(header_, map_size_);
+    if (fd_ != -1)
+        close(fd_);
+}
+
+// Maps the index, creating the directory and an empty index if needed. An
+// index in another format or of another size is started over.
+bool DiskCache::Open() {
+    if (mkdir(dir_.c_str(), 0755) == -1 && errno != EEXIST) {
+        std::cout << "Failed to create cache directory " << dir_ << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    std::string index = dir_ + "/index";
+    if ((fd_ = open(index.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)) == -1) {
+        std::cout << "Failed to open cache index " << index << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    map_size_ = sizeof(Header) + slots_ * sizeof(Slot);
+    struct stat st;
+    bool fresh = fstat(fd_, &st) == -1 || static_cast<size_t>(st.st_size) != map_size_;
+    if (fresh && (ftruncate(fd_, 0) == -1 || ftruncate(fd_, map_size_) == -1)) {
+        std::cout << "Failed to size cache index: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    void* map = mmap(NULL, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        std::cout << "Failed to map cache index: " << strerror(errno) << std::endl;
+        return false;
+    }
+    header_ = static_cast<Header*>(map);
+    table_ = reinterpret_cast<Slot*>(static_cast<char*>(map) + sizeof(Header));
+
+    if (fresh || memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0 || header_->version != kVersion ||
+        header_->slots != slots_) {
+        memset(map, 0, map_size_);
+        memcpy(header_->magic, kMagic, sizeof(kMagic));
+        header_->version = kVersion;
+        header_->slots = slots_;
+    }
+    return true;
+}
+
+std::string DiskCache::Key(const URI& uri) {
+    return "http://" + uri.Host + ":" + (uri.Port.empty() ? "80" : uri.Port) + uri.Path + uri.QueryString;
+}
+
+DiskCache::Match DiskCache::Lookup(const std::string& url, const Request& request, CacheEntry* entry) {
+    Slot* slot = header_ ? Find(url, HashKey(url)) : nullptr;
+    if (slot == nullptr || Varied(slot->vary, request.Headers()) != slot->varied) {
+        ++misses_;
+        return kMissing;
+    }
+    slot->used = ++header_->tick;
+    ToEntry(*slot, entry);
+    if (!entry->Fresh(time(nullptr)))
+        return kStale;
+    ++hits_;
+    return kFresh;
+}
+
+bool DiskCache::Store(const std::string& url, const Request& request, const Response& res, const std::string& path) {
+    if (header_ == nullptr || url.length() >= sizeof(Slot::url))
+        return false;
+    std::string_view cache_control = res.Headers().Get(kCacheControl);
+    std::string_view vary = res.Headers().Get(kVary);
+    std::string varied = Varied(vary, request.Headers());
+    if (res.StatusCode() != 200 || Directive(cache_control, "no-store", NULL) || Directive(vary, "*", NULL) ||
+        vary.length() >= sizeof(Slot::vary) || varied.length() >= sizeof(Slot::varied)) {
+        Remove(url);
+        return false;
+    }
+
+    struct stat st;
+    if (stat(path.c_str(), &st) == -1 || st.st_size > max_bytes_)
+        return false;
+
+    // Write the body under a temporary name so a crash never leaves an
+    // index entry pointing at half a file.
+    uint64_t hash = HashKey(url);
+    std::string blob = BlobPath(hash);
+    if (!CopyFile(path, blob + ".tmp") || rename((blob + ".tmp").c_str(), blob.c_str()) == -1) {
+        unlink((blob + ".tmp").c_str());
+        return false;
+    }
+
+    Slot* slot = Find(url, hash);
+    if (slot != nullptr) {
+        header_->bytes -= slot->size;
+    } else {
+        slot = Claim(hash);
+        ++header_->entries;
+    }
+    Fill(slot, url, hash, res);
+    SetField(slot->vary, vary);
+    SetField(slot->varied, varied);
+    slot->size = st.st_size;
+    header_->bytes += st.st_size;
+    Evict();
+    return true;
+}
+
+bool DiskCache::Refresh(const std::string& url, const Response& res, CacheEntry* entry) {
+    Slot* slot = header_ ? Find(url, HashKey(url)) : nullptr;
+    if (slot == nullptr)
+        return false;
+    ++revalidated_;
+
+    // A 304 only carries the headers that changed, if any.
+    const HeaderMap& headers = res.Headers();
+    if (headers.Has(kETag))
+        SetField(slot->etag, headers.Get(kETag));
+    if (headers.Has(kLastModified))
+        SetField(slot->last_modified, headers.Get(kLastModified));
+    if (headers.Has(kCacheControl))
+        SetField(slot->cache_control, headers.Get(kCacheControl));
+    time_t now = time(nullptr);
+    slot->stored = now;
+    slot->expires = Expiry(headers, slot->cache_control, slot->last_modified, now);
+    slot->used = ++header_->tick;
+    ToEntry(*slot, entry);
+    return true;
+}
+
+bool DiskCache::Remove(const std::string& url) {
+    Slot* slot = header_ ? Find(url, HashKey(url)) : nullptr;
+    if (slot == nullptr)
+        return false;
+    Drop(slot);
+    return true;
+}
+
+int64_t DiskCache::Bytes() const {
+    return header_ ? header_->bytes : 0;
+}
+
+size_t DiskCache::Entries() const {
+    return header_ ? header_->entries : 0;
+}
+
+// Open addressing with linear probing; deleted slots keep the probe chain
+// going until they are reused.
+DiskCache::Slot* DiskCache::Find(const std::string& url, uint64_t hash) const {
+    for (size_t n = 0, i = hash % slots_; n < slots_; ++n, i = (i + 1) % slots_) {
+        Slot* slot = &table_[i];
+        if (slot->hash == kEmpty)
+            return nullptr;
+        if (slot->hash == hash && url == slot->url)
+            return slot;
+    }
+    return nullptr;
+}
+
+// Returns a free slot for hash, evicting the least recently used entry if
+// the table is full.
+DiskCache::Slot* DiskCache::Claim(uint64_t hash) {
+    for (size_t n = 0, i = hash % slots_; n < slots_; ++n, i = (i + 1) % slots_) {
+        if (table_[i].hash == kEmpty || table_[i].hash == kDeleted)
+            return &table_[i];
+    }
+    Slot* oldest = nullptr;
+    for (size_t i = 0; i < slots_; ++i) {
+        if (oldest == nullptr || table_[i].used < oldest->used)
+            oldest = &table_[i];
+    }
+    Drop(oldest);
+    return oldest;
+}
+
+void DiskCache::Fill(Slot* slot, const std::string& url, uint64_t hash, const Response& res) {
+    const HeaderMap& headers = res.Headers();
+    time_t now = time(nullptr);
+    slot->hash = hash;
+    slot->used = ++header_->tick;
+    slot->stored = now;
+    SetField(slot->url, url);
+    // Validators too long for the slot are dropped; the entry is then
+    // refetched in full once it goes stale.
+    if (!SetField(slot->etag, headers.Get(kETag)))
+        slot->etag[0] = '\0';
+    if (!SetField(slot->last_modified, headers.Get(kLastModified)))
+        slot->last_modified[0] = '\0';
+    if (!SetField(slot->cache_control, headers.Get(kCacheControl)))
+        slot->cache_control[0] = '\0';
+    slot->expires = Expiry(headers, headers.Get(kCacheControl), headers.Get(kLastModified), now);
+}
+
+// Drops least recently used entries until the bodies fit in the budget.
+void DiskCache::Evict() {
+    while (header_->bytes > max_bytes_ && header_->entries > 0) {
+        Slot* oldest = nullptr;
+        for (size_t i = 0; i < slots_; ++i) {
+            if (table_[i].hash > kDeleted && (oldest == nullptr || table_[i].used < oldest->used))
+                oldest = &table_[i];
+        }
+        if (oldest == nullptr)
+            break;
+        Drop(oldest);
+    }
+}
+
+void DiskCache::Drop(Slot* slot) {
+    unlink(BlobPath(slot->hash).c_str());
+    header_->bytes -= slot->size;
+    --header_->entries;
+    memset(slot, 0, sizeof(*slot));
+    slot->hash = kDeleted;
+}
+
+std::string DiskCache::BlobPath(uint64_t hash) const {
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+    return dir_ + "/" + name;
+}
+
+void DiskCache::ToEntry(const Slot& slot, CacheEntry* entry) const {
+    entry->url = slot.url;
+    entry->etag = slot.etag;
+    entry->last_modified = slot.last_modified;
+    entry->cache_control = slot.cache_control;
+    entry->blob = BlobPath(slot.hash);
+    entry->size = slot.size;
+    entry->stored = slot.stored;
+    entry->expires = slot.expires;
+}
+
+// Copies a file in the kernel: copy_file_range where the filesystem
+// supports it (and can share blocks), sendfile otherwise.
+bool DiskCache::CopyFile(const std::string& from, const std::string& to) {
+    int in = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in == -1)
+        return false;
+    int out = open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out == -1) {
+        close(in);
+        return false;
+    }
+
+    struct stat st;
+    bool ok = fstat(in, &st) == 0;
+    int64_t left = ok ? st.st_size : 0;
+    bool use_sendfile = false;
+    while (ok && left > 0) {
+        ssize_t n;
+        if (!use_sendfile) {
+            n = copy_file_range(in, NULL, out, NULL, left, 0);
+            if (n == -1 && (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP)) {
+                use_sendfile = true;
+                continue;
+            }
+        } else {
+            n = sendfile(out, in, NULL, left);
+        }
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        left -= n;
+    }
+
+    close(in);
+    if (close(out) == -1)
+        ok = false;
+    return ok;
+}
+
+}  // namespace http
@@ -0,0 +1,103 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_CACHE_H_
+#define CODE_HTTPCLIENT_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+#include "message.h"
+
+namespace http {
+
+// What the cache knows about one stored response.
+struct CacheEntry {
+  std::string url;
+  std::string etag;
+  std::string last_modified;
+  std::string cache_control;
+  std::string blob;  // path of the stored body
+  int64_t size = 0;
+  time_t stored = 0;   // when the response was received or last revalidated
+  time_t expires = 0;  // fresh until then
+
+  bool Fresh(time_t now) const { return now < expires; }
+  bool CanRevalidate() const { return !etag.empty() || !last_modified.empty(); }
+};
+
+// A persistent cache of GET response bodies in a directory. The index is
+// a fixed table of slots in a file that is mmap'd, so it survives the
+// process and costs nothing to load; each body is a file of its own next
+// to it. Freshness follows Cache-Control max-age, then Expires, then the
+// usual heuristic of a tenth of the time since Last-Modified. A response
+// with Vary is only served to requests that repeat the headers it names,
+// and one that varies on everything (Vary: *) isn't kept. The least
+// recently used entries are dropped to keep the bodies under max_bytes.
+//
+// One process at a time; the index isn't locked.
+class DiskCache {
+ public:
+  static constexpr size_t kDefaultSlots = 4096;
+
+  DiskCache(const std::string& dir, int64_t max_bytes, size_t slots = kDefaultSlots)
+      : dir_{dir}, max_bytes_{max_bytes}, slots_{slots} {}
+  DiskCache(const DiskCache&) = delete;
+  DiskCache& operator=(const DiskCache&) = delete;
+  ~DiskCache();
+
+  bool Open();
+
+  enum Match { kMissing, kFresh, kStale };
+
+  // Finds the entry for url that request can be answered with and marks it
+  // used. A fresh entry counts as a hit and a missing one as a miss; how a
+  // stale one turns out is for the caller to say, with Refresh or Missed.
+  Match Lookup(const std::string& url, const Request& request, CacheEntry*);
+  // Stores res, the answer to request, whose body is in the file at path,
+  // under url. Responses marked no-store aren't kept.
+  bool Store(const std::string& url, const Request& request, const Response& res, const std::string& path);
+  // Takes the headers of a 304 answering a revalidation: the entry is
+  // fresh again and picks up any new validators. entry gets the result.
+  // Counts a revalidation.
+  bool Refresh(const std::string& url, const Response& res, CacheEntry* entry);
+  // Counts a miss for a stale entry that couldn't be revalidated.
+  void Missed() { ++misses_; }
+  bool Remove(const std::string& url);
+
+  int64_t Bytes() const;
+  size_t Entries() const;
+  uint64_t Hits() const { return hits_; }
+  uint64_t Misses() const { return misses_; }
+  uint64_t Revalidated() const { return revalidated_; }
+
+  static std::string Key(const URI&);
+  static bool CopyFile(const std::string& from, const std::string& to);
+
+ private:
+  struct Header;
+  struct Slot;
+
+  Slot* Find(const std::string&, uint64_t) const;
+  Slot* Claim(uint64_t);
+  void Fill(Slot*, const std::string&, uint64_t, const Response&);
+  void Evict();
+  void Drop(Slot*);
+  std::string BlobPath(uint64_t) const;
+  void ToEntry(const Slot&, CacheEntry*) const;
+
+  std::string dir_;
+  int64_t max_bytes_;
+  size_t slots_;
+  int fd_ = -1;
+  size_t map_size_ = 0;
+  Header* header_ = nullptr;
+  Slot* table_ = nullptr;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t revalidated_ = 0;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_CACHE_H_
@@ -0,0 +1,813 @@
+// Copyright hopkiw 2026
+#include "client.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer.h"
+#include "fetcher.h"
+#include "headers.h"
+#include "inflate.h"
+#include "parser.h"
+#include "resume.h"
+#include "timing.h"
+#include "writer.h"
+
+namespace http {
+
+// Dot segments are resolved first, so "/../x" is x and not a file outside
+// the directory, and leading slashes dropped, so the path stays relative.
+std::string LocalPath(const URI& uri) {
+    bool rooted = !uri.Path.empty() && uri.Path[0] == '/';
+    std::string newpath = internal::RemoveDotSegments(rooted ? uri.Path : "/" + uri.Path);
+    newpath.erase(0, newpath.find_first_not_of('/'));
+    return newpath.empty() ? "index.html" : newpath;
+}
+
+namespace {
+
+// A 200 standing in for a response served from the cache.
+Response CachedResponse(const CacheEntry& entry) {
+    Response res(200);
+    res.AddHeader(kContentLength.name, std::to_string(entry.size));
+    if (!entry.etag.empty())
+        res.AddHeader(kETag.name, entry.etag);
+    if (!entry.last_modified.empty())
+        res.AddHeader(kLastModified.name, entry.last_modified);
+    if (!entry.cache_control.empty())
+        res.AddHeader(kCacheControl.name, entry.cache_control);
+    return res;
+}
+
+bool IsRedirect(int status) {
+    return status == 301 || status == 302 || status == 303 || status == 307 || status == 308;
+}
+
+// Permanent redirects (301 and 308) met so far, by URL, shared by every
+// Client in the process.
+class RedirectCache {
+ public:
+  bool Lookup(const std::string& url, Response* res) {
+      std::lock_guard<std::mutex> lock(mu_);
+      auto it = targets_.find(url);
+      if (it == targets_.end())
+          return false;
+      *res = Response(it->second.first);
+      res->AddHeader(kLocation.name, it->second.second);
+      return true;
+  }
+  void Store(const std::string& url, int status, const std::string& target) {
+      std::lock_guard<std::mutex> lock(mu_);
+      targets_[url] = std::make_pair(status, target);
+  }
+
+ private:
+  std::mutex mu_;
+  std::map<std::string, std::pair<int, std::string>> targets_;
+};
+
+RedirectCache& Redirects() {
+    static RedirectCache cache;
+    return cache;
+}
+
+// The request to send to target after a redirect with status. 303 turns
+// anything but HEAD into a GET, and so, as browsers do, does a 301 or 302
+// answering a POST; otherwise the method and body stay as they were (RFC
+// 9110 section 15.4). Credentials aren't passed on to another origin.
+Request Redirected(const Request& request, const URI& target, int status) {
+    const std::string& method = request.Method();
+    bool to_get = (status == 303 && method != "HEAD") || ((status == 301 || status == 302) && method == "POST");
+    const URI& from = request.Uri();
+    bool same_origin = EqualsIgnoreCase(from.Host, target.Host) &&
+                       (from.Port.empty() ? "80" : from.Port) == (target.Port.empty() ? "80" : target.Port);
+
+    Request next(target, to_get ? "GET" : method);
+    if (!to_get)
+        next.CopyBody(request);
+    for (const auto& field : request.Headers()) {
+        if (to_get && (EqualsIgnoreCase(field.name, kContentLength.name) ||
+                       EqualsIgnoreCase(field.name, kContentType.name) ||
+                       EqualsIgnoreCase(field.name, kTransferEncoding.name) || EqualsIgnoreCase(field.name, "Expect")))
+            continue;
+        if (!same_origin && (EqualsIgnoreCase(field.name, "Authorization") || EqualsIgnoreCase(field.name, "Cookie")))
+            continue;
+        next.AddHeader(field.name, field.value);
+    }
+    return next;
+}
+
+// Passes a response body on to next, unless the response is a redirect,
+// whose body is only there for clients that don't follow it.
+class RedirectSink : public BodySink {
+ public:
+  RedirectSink(const Response* res, BodySink* next) : res_{res}, next_{next} {}
+
+  void Head(const Response& res) override {
+      if (!(IsRedirect(res.StatusCode()) && !res.Location().empty()))
+          next_->Head(res);
+  }
+  bool Begin(int64_t length) override {
+      skip_ = IsRedirect(res_->StatusCode()) && !res_->Location().empty();
+      return skip_ || next_->Begin(length);
+  }
+  bool Write(const char* data, size_t len) override { return skip_ || next_->Write(data, len); }
+  bool Finish() override { return skip_ || next_->Finish(); }
+  bool CanSplice() const override { return !skip_ && next_->CanSplice(); }
+  ssize_t Splice(int fd, size_t len) override { return next_->Splice(fd, len); }
+
+ private:
+  const Response* res_;
+  BodySink* next_;
+  bool skip_ = false;
+};
+
+}  // namespace
+
+// Sends request and writes the body to a file named after the URI path,
+// following redirects (see Follow).
+Response Client::Do(const Request& request) {
+    return Follow(request, nullptr);
+}
+
+// Sends request and hands the body to sink, following redirects.
+Response Client::Do(const Request& request, BodySink* sink) {
+    return Follow(request, sink);
+}
+
+// Runs request and the requests its redirects lead to, up to
+// max_redirects_ of them. Each response comes from Once, or from Fetch if
+// there is a sink; the body of the one that isn't a redirect goes to sink
+// or to the file named after the original URI, never one the server
+// chose. Redirects to a URL already visited, or to anything but http,
+// end it there with the redirect as the response. Permanent redirects are
+// remembered for the life of the process and not asked again.
+Response Client::Follow(const Request& request, BodySink* sink) {
+    std::string path = LocalPath(request.Uri());
+    last_uri_ = request.Uri();
+    Request current = request;
+    std::set<std::string> visited;
+    for (int hops = 0; ; ++hops) {
+        std::string url = DiskCache::Key(current.Uri());
+        visited.insert(url);
+
+        Response res;
+        std::string remembered;
+        if (max_redirects_ > 0 && Redirects().Lookup(url, &res)) {
+            remembered = std::string(res.Location());
+            timing_ = RequestTiming();
+        } else {
+            res = sink != nullptr ? Fetch(current, path, sink) : Once(current, path);
+        }
+        if (max_redirects_ == 0 || !IsRedirect(res.StatusCode()) || res.Location().empty())
+            return res;
+
+        URI target = current.Uri().Resolve(res.Location());
+        std::string next = DiskCache::Key(target);
+        if (target.Host.empty() || !(target.Protocol.empty() || EqualsIgnoreCase(target.Protocol, "http"))) {
+            std::cout << "not following redirect to " << res.Location() << std::endl;
+            return res;
+        }
+        if (visited.count(next) != 0) {
+            std::cout << "redirect loop at " << next << std::endl;
+            return res;
+        }
+        if (hops == max_redirects_) {
+            std::cout << "stopped after " << hops << " redirects" << std::endl;
+            return res;
+        }
+        if (remembered.empty() && (res.StatusCode() == 301 || res.StatusCode() == 308))
+            Redirects().Store(url, res.StatusCode(), next);
+        std::cout << res.StatusCode() << (remembered.empty() ? "" : " (remembered)") << " redirect to " << next
+                  << std::endl;
+        // A produced body is gone once sent; there's no second copy to send on.
+        if (current.Body() == Request::kProducedBody && (res.StatusCode() == 307 || res.StatusCode() == 308)) {
+            std::cout << "can't send a streamed body again to " << next << std::endl;
+            return res;
+        }
+        current = Redirected(current, target, res.StatusCode());
+        last_uri_ = target;
+    }
+}
+
+// Sends request and writes the body to path. With a cache set, GETs are
+// answered from it while fresh and revalidated with a conditional request
+// once stale.
+Response Client::Once(const Request& request, const std::string& local) {
+    if (cache_ == nullptr || request.Method() != "GET" || request.HasHeader("Range") ||
+        request.HasHeader("If-None-Match") || request.HasHeader("If-Modified-Since"))
+        return Fetch(request, local);
+
+    // The Accept-Encoding Fetch would add goes on here, where the cache can
+    // match it against a Vary.
+    Request sent = request;
+    if (compression_ && !resume_ && !sent.HasHeader(kAcceptEncoding))
+        sent.AddHeader(kAcceptEncoding.name, "gzip, deflate");
+
+    std::string url = DiskCache::Key(request.Uri());
+    std::string path = "./" + local;
+    CacheEntry entry;
+    DiskCache::Match match = cache_->Lookup(url, sent, &entry);
+    if (match == DiskCache::kFresh) {
+        if (DiskCache::CopyFile(entry.blob, path)) {
+            std::cout << "served " << path << " from cache" << std::endl;
+            timing_ = RequestTiming();
+            return CachedResponse(entry);
+        }
+        cache_->Remove(url);
+        match = DiskCache::kMissing;
+    }
+    bool cached = match == DiskCache::kStale;
+
+    Request conditional = sent;
+    if (cached && !entry.etag.empty())
+        conditional.AddHeader("If-None-Match", entry.etag);
+    if (cached && !entry.last_modified.empty())
+        conditional.AddHeader("If-Modified-Since", entry.last_modified);
+
+    Response res = Fetch(conditional, local);
+    if (cached && res.StatusCode() == 304) {
+        if (cache_->Refresh(url, res, &entry) && DiskCache::CopyFile(entry.blob, path)) {
+            std::cout << "revalidated " << path << " from cache" << std::endl;
+            Response ok = CachedResponse(entry);
+            ok.SetRecvBytes(res.RecvBytes());
+            return ok;
+        }
+        cache_->Remove(url);
+        return Fetch(sent, local);
+    }
+    if (cached)
+        cache_->Missed();
+    // Fetch gives -1 unless the body arrived in full and was written out,
+    // so a 200 is safe to keep.
+    if (res.StatusCode() == 200)
+        cache_->Store(url, sent, res, path);
+    else
+        cache_->Remove(url);
+    return res;
+}
+
+// One request, bypassing the cache and not following redirects. The body
+// goes to sink if set, or else to the file newpath.
+Response Client::Fetch(const Request& request, const std::string& newpath, BodySink* sink) {
+    auto start = Clock::now();
+    timing_ = RequestTiming();
+    Response res;
+    const URI& uri = request.Uri();
+    std::string port = uri.Port.empty() ? "80" : uri.Port;
+    std::string key = ConnectionPool::Key(uri.Host, port);
+
+    Request keepalive = request;
+    if (!keepalive.HasHeader("Connection"))
+        keepalive.AddHeader("Connection", "keep-alive");
+    // A partial file holds decoded bytes, so a body that may be resumed
+    // can't be compressed: neither the one picking up a partial file nor
+    // the fresh one (offset 0) that may later be picked up, whose
+    // validator would otherwise belong to the encoded variant.
+    int64_t resume_from = -1;
+    if (resume_ && sink == nullptr && request.Method() == "GET" && !request.HasHeader("Range"))
+        resume_from = ResumeSink::Prepare("./" + newpath, &keepalive);
+    if (compression_ && resume_from < 0 && !keepalive.HasHeader(kAcceptEncoding))
+        keepalive.AddHeader(kAcceptEncoding.name, "gzip, deflate");
+
+    // A pooled connection can still be closed by the server between the
+    // health check and our send; that shows up as a failure before any
+    // response byte, and the request is retried once on a fresh connection.
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (!pool_.Acquire(key, &conn_)) {
+            std::cout << "too many connections to " << key << std::endl;
+            return res;
+        }
+        bool reused = conn_.fd != -1;
+        timing_.reused = reused;
+        if (!reused && Connect(uri.Host, port) != 0) {
+            std::cout << "error connecting" << std::endl;
+            pool_.Release(&conn_, false);
+            return res;
+        }
+
+        bool stale = false;
+        bool reusable = RoundTrip(keepalive, newpath, sink, resume_from, &res, &stale);
+        ++conn_.requests;
+        pool_.Release(&conn_, reusable);
+        if (!(stale && reused) || request.Body() == Request::kProducedBody)
+            break;
+        res = Response();
+    }
+
+    timing_.phase[kTotal] = Clock::now() - start;
+    if (res.StatusCode() != -1)
+        histograms_.Record(timing_);
+
+    // The partial file is longer than the resource is now.
+    if (resume_from > 0 && res.StatusCode() == 416) {
+        ResumeSink::Discard("./" + newpath);
+        return Fetch(request, newpath, sink);
+    }
+    return res;
+}
+
+// Sends requests without waiting for each response (HTTP/1.1 pipelining)
+// and reads the responses back in order, so a batch of small objects from
+// one origin costs about one round trip instead of one each. Requests to
+// different origins are pipelined on separate connections. done, if set,
+// is called with each request's index as soon as its response is in.
+//
+// Redirects aren't followed here; a redirect comes back as the response,
+// without its body. Only bodies held in memory can be pipelined; requests
+// with a file or produced body fail.
+//
+// If the server closes the connection with requests still unanswered, the
+// idempotent ones are sent again on a new connection; the others fail, as
+// there's no telling whether the server acted on them.
+std::vector<Response> Client::DoMany(const std::vector<Request>& requests, ManyCallback done) {
+    std::vector<Response> responses(requests.size());
+    std::vector<Request> sent(requests);
+    std::vector<Clock::time_point> written_at(requests.size());
+    std::map<std::string, std::deque<size_t>> origins;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const URI& uri = requests[i].Uri();
+        if (requests[i].Body() == Request::kFileBody || requests[i].Body() == Request::kProducedBody) {
+            std::cout << "not pipelining " << requests[i].Method() << " " << uri.Path << " with a streamed body"
+                      << std::endl;
+            if (done)
+                done(i, responses[i]);
+            continue;
+        }
+        origins[ConnectionPool::Key(uri.Host, uri.Port.empty() ? "80" : uri.Port)].push_back(i);
+    }
+
+    for (auto& origin : origins) {
+        std::deque<size_t>& unanswered = origin.second;
+        const URI& uri = requests[unanswered.front()].Uri();
+        std::string port = uri.Port.empty() ? "80" : uri.Port;
+
+        int failures = 0;
+        while (!unanswered.empty() && failures < kPipelineAttempts) {
+            if (!pool_.Acquire(origin.first, &conn_)) {
+                std::cout << "too many connections to " << origin.first << std::endl;
+                break;
+            }
+            auto start = Clock::now();
+            timing_ = RequestTiming();
+            bool reused = conn_.fd != -1;
+            if (!reused && Connect(uri.Host, port) != 0) {
+                std::cout << "error connecting" << std::endl;
+                pool_.Release(&conn_, false);
+                ++failures;
+                continue;
+            }
+            RequestTiming setup = timing_;
+
+            // Keep up to kPipelineDepth requests in flight, topping up as
+            // responses come back. Sending everything at once could leave
+            // both sides blocked writing to each other.
+            RequestWriter writer;
+            size_t in_flight = 0;
+            auto top_up = [&]() {
+                while (in_flight < unanswered.size() && in_flight < kPipelineDepth) {
+                    Request& request = sent[unanswered[in_flight++]];
+                    if (!request.HasHeader("Connection"))
+                        request.AddHeader("Connection", "keep-alive");
+                    if (compression_ && !request.HasHeader(kAcceptEncoding))
+                        request.AddHeader(kAcceptEncoding.name, "gzip, deflate");
+                    writer.Add(request);
+                    written_at[unanswered[in_flight - 1]] = Clock::now();
+                }
+                return writer.Flush(conn_.fd);
+            };
+
+            std::string extra;
+            bool reusable = top_up();
+            bool progress = false;
+            while (reusable && !unanswered.empty()) {
+                size_t i = unanswered.front();
+                Response res;
+                bool stale = false;
+                // Only the first response on a connection waited for it to
+                // be set up; the rest count from when they were written.
+                timing_ = progress ? RequestTiming() : setup;
+                timing_.reused = reused || progress;
+                sent_at_ = written_at[i];
+                if (!ReadResponse(sent[i], LocalPath(sent[i].Uri()), nullptr, -1, &extra, &res, &reusable, &stale)) {
+                    reusable = false;
+                    break;
+                }
+                timing_.phase[kTotal] = Clock::now() - (progress ? written_at[i] : start);
+                histograms_.Record(timing_);
+                ++conn_.requests;
+                responses[i] = res;
+                unanswered.pop_front();
+                --in_flight;
+                progress = true;
+                if (done)
+                    done(i, responses[i]);
+                if (reusable)
+                    reusable = top_up();
+            }
+            pool_.Release(&conn_, reusable && extra.empty());
+            failures = progress ? 0 : failures + 1;
+
+            // Whatever is left was either never sent or lost with the
+            // connection. Only requests that are safe to repeat go again.
+            std::deque<size_t> retry;
+            for (size_t n = 0; n < unanswered.size(); ++n) {
+                size_t i = unanswered[n];
+                if (n >= in_flight || sent[i].Idempotent()) {
+                    retry.push_back(i);
+                } else {
+                    std::cout << "not retrying " << sent[i].Method() << " " << sent[i].Uri().Path << std::endl;
+                    if (done)
+                        done(i, responses[i]);
+                }
+            }
+            unanswered.swap(retry);
+        }
+
+        for (size_t i : unanswered) {
+            if (done)
+                done(i, responses[i]);
+        }
+    }
+
+    return responses;
+}
+
+// Sends request on conn_ and reads one response, writing the body to path
+// or, if set, to target. Returns whether the connection can be reused.
+// res's status is -1 unless the whole response arrived. stale is set when
+// the connection failed before any part of the response arrived.
+bool Client::RoundTrip(const Request& request, const std::string& path, BodySink* target, int64_t resume_from,
+                       Response* res, bool* stale) {
+    RequestWriter writer;
+    writer.Add(request);
+    sent_at_ = Clock::now();
+    if (!writer.Flush(conn_.fd)) {
+        *stale = true;
+        std::cout << "Failed to send message" << std::endl;
+        return false;
+    }
+
+    // A body held in memory went out with the head. Any other is sent now,
+    // unless the server turns it down first, in which case the connection
+    // is left mid-request and can't be reused.
+    std::string extra;
+    bool sent = true;
+    if (request.Body() == Request::kFileBody || request.Body() == Request::kProducedBody) {
+        sent = !request.ExpectsContinue() || AwaitContinue(&extra);
+        if (sent && !SendBody(request)) {
+            // The server may have answered before hanging up; read on.
+            std::cout << "Failed to send request body" << std::endl;
+            sent = false;
+        }
+        sent_at_ = Clock::now();
+    }
+
+    // A head whose body didn't arrive in full isn't a response to act on,
+    // so it fails like one that never came.
+    bool reusable = false;
+    if (!ReadResponse(request, path, target, resume_from, &extra, res, &reusable, stale)) {
+        res->SetStatusCode(-1);
+        return false;
+    }
+    // Bytes past the end of the response were never asked for.
+    return reusable && extra.empty() && sent;
+}
+
+// Waits up to kContinueWait for the server to answer a request sent with
+// Expect: 100-continue. Returns true on 100 Continue, or if the server
+// says nothing in time, as it may not know about 100 Continue (RFC 9110
+// section 10.1.1). Returns false if the server answers with a final
+// response instead, which is left in extra for ReadResponse.
+bool Client::AwaitContinue(std::string* extra) {
+    auto deadline = Clock::now() + kContinueWait;
+    Buffer buf = BufferPool::Default().Get(kRecvSize);
+    while (true) {
+        Response interim;
+        int len = interim.Parse(*extra);
+        if (len < 0)
+            return false;
+        if (len > 0 && interim.StatusCode() == 100) {
+            extra->erase(0, len);
+            return true;
+        }
+        // 101 and final responses are for ReadResponse; other 1xx don't
+        // settle anything.
+        if (len > 0 && (interim.StatusCode() >= 200 || interim.StatusCode() == 101))
+            return false;
+        if (len > 0) {
+            extra->erase(0, len);
+            continue;
+        }
+
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+        if (left.count() <= 0)
+            return true;
+        struct pollfd pfd = {conn_.fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, left.count());
+        if (ready == -1 && errno == EINTR)
+            continue;
+        if (ready <= 0)
+            return ready == 0;
+        ssize_t n = recv(conn_.fd, buf.Data(), buf.Capacity(), 0);
+        if (n <= 0)
+            return false;
+        extra->append(buf.Data(), n);
+    }
+}
+
+// Sends the body of request, when it isn't held in memory: a file with
+// sendfile, so it goes from the page cache to the socket without passing
+// through us, or the producer's pieces, each as a chunk if the body is
+// chunked.
+bool Client::SendBody(const Request& request) {
+    if (request.Body() == Request::kFileBody) {
+        int fd = open(request.BodyPath().c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            std::cout << "Failed to open " << request.BodyPath() << std::endl;
+            return false;
+        }
+        off_t offset = 0;
+        while (offset < request.BodyLength()) {
+            ssize_t n = sendfile(conn_.fd, fd, &offset, request.BodyLength() - offset);
+            if (n == -1 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                // n is 0 if the file got shorter since the head went out.
+                close(fd);
+                return false;
+            }
+        }
+        close(fd);
+        return true;
+    }
+
+    bool chunked = request.ChunkedBody();
+    std::string chunk;
+    while (true) {
+        chunk.clear();
+        if (!request.Producer()(&chunk))
+            return false;
+        RequestWriter writer;
+        char size[32];
+        if (chunked) {
+            char* end = std::to_chars(size, size + sizeof(size) - 2, chunk.length(), 16).ptr;
+            *end++ = '\r';
+            *end++ = '\n';
+            writer.Add(std::string_view(size, end - size));
+        }
+        writer.Add(chunk);
+        // The last chunk is "0\r\n\r\n", with no trailer fields.
+        if (chunked)
+            writer.Add("\r\n");
+        if (!writer.Flush(conn_.fd))
+            return false;
+        if (chunk.empty())
+            return true;
+    }
+}
+
+// Reads one response to request from conn_, writing the body to path, or
+// handing it to target if that is set. Unless resume_from is -1 the body
+// goes through a ResumeSink, which picks up a partial download at that
+// offset (see ResumeSink::Prepare). extra holds bytes already read from
+// the connection that come before the response, and on return holds
+// whatever followed it, which belongs to the next pipelined response.
+// Returns whether the whole response arrived; reusable says whether the
+// connection can carry another, and stale is set when the connection
+// failed before any part of the response arrived.
+bool Client::ReadResponse(const Request& request, const std::string& path, BodySink* target, int64_t resume_from,
+                          std::string* extra, Response* res, bool* reusable, bool* stale) {
+    Buffer buf = BufferPool::Default().Get(kRecvSize);
+    ssize_t recv_bytes = 0;
+
+    FileSink file("./" + path, &throughput_);
+    BodySink* out = target != nullptr ? target : &file;
+    InflateSink inflate(res, out, &throughput_);
+    ResumeSink resume("./" + path, resume_from, res, &file);
+    BodySink& body = resume_from >= 0 ? static_cast<BodySink&>(resume)
+                   : compression_ ? static_cast<BodySink&>(inflate) : *out;
+    RedirectSink redirect(res, &body);
+    BodySink& sink = max_redirects_ > 0 ? static_cast<BodySink&>(redirect) : body;
+    ResponseParser parser(res, request.Method() == "HEAD", &sink);
+    *reusable = false;
+
+    Clock::time_point first_byte;
+    if (!extra->empty()) {
+        first_byte = Clock::now();
+        size_t used = parser.Feed(extra->data(), extra->length());
+        if (parser.Failed())
+            return false;
+        extra->erase(0, used);
+    }
+
+    while (!parser.Done()) {
+        // Once the parser is inside a large run of body bytes, splice them
+        // to the file instead of copying them through buf.
+        size_t direct = parser.Direct();
+        if (direct >= kSpliceMin && sink.CanSplice()) {
+            ssize_t n = sink.Splice(conn_.fd, direct);
+            if (n == -1) {
+                std::cout << "Failed to recv message" << std::endl;
+                return false;
+            }
+            if (n == 0) {
+                if (!parser.Finish()) {
+                    std::cout << "Connection closed by remote host." << std::endl;
+                    return false;
+                }
+                break;
+            }
+            parser.Skip(n);
+            continue;
+        }
+
+        recv_bytes = recv(conn_.fd, buf.Data(), buf.Capacity(), 0);
+        if (recv_bytes > 0 && first_byte == Clock::time_point())
+            first_byte = Clock::now();
+        if (recv_bytes == -1) {
+            *stale = !parser.Started();
+            std::cout << "Failed to recv message" << std::endl;
+            return false;
+        }
+
+        if (recv_bytes == 0) {
+            *stale = !parser.Started();
+            if (!parser.Finish()) {
+                std::cout << "Connection closed by remote host." << std::endl;
+                return false;
+            }
+            break;
+        }
+
+        size_t used = parser.Feed(buf.Data(), recv_bytes);
+        if (parser.Failed())
+            return false;
+        extra->append(buf.Data() + used, recv_bytes - used);
+    }
+
+    auto end = Clock::now();
+    timing_.phase[kFirstByte] = first_byte - sent_at_;
+    timing_.phase[kTransfer] = end - first_byte;
+
+    if (!sink.Finish())
+        return false;
+    if (file.Begun())
+        std::cout << "wrote file " << path << std::endl;
+    if (target != nullptr && parser.BodyBytes() > 0) {
+        throughput_.Add(parser.BodyBytes(), false);
+        throughput_.AddTime(end - first_byte);
+    }
+
+    *reusable = parser.Reusable();
+    return true;
+}
+
+// Connects conn_ to domain:port over whichever of its IPv6 and IPv4
+// addresses answers first.
+int Client::Connect(const std::string& domain, const std::string& port) {
+    auto start = Clock::now();
+    std::vector<Address> addrs;
+    int err = resolver_->Resolve(domain, port, AF_UNSPEC, &addrs);
+    auto resolved = Clock::now();
+    timing_.phase[kResolve] = resolved - start;
+    if (err != 0) {
+        std::cout << "error looking up host" << std::endl;
+        return 1;
+    }
+
+    Dialer::Interleave(&addrs);
+    conn_.fd = dialer_.Dial(addrs);
+    timing_.phase[kConnect] = Clock::now() - resolved;
+    return conn_.fd == -1 ? 1 : 0;
+}
+
+// Downloads one large resource over several connections at once. A HEAD
+// request finds the length and whether the server takes byte ranges; the
+// body is then split into up to segments ranges, each fetched on its own
+// connection and written at its offset in one preallocated file. A range
+// that fails is resumed from where it stopped without touching the others.
+// Falls back to Do when ranges aren't on offer.
+Response Client::DownloadSegmented(const Request& request, int segments) {
+    const URI& uri = request.Uri();
+    // Ranges are of the unencoded body, so the length must be too.
+    Request head(uri, "HEAD");
+    head.AddHeader(kAcceptEncoding.name, "identity");
+    Response probe = Do(head);
+    if (!probe.OK())
+        return probe;
+
+    int64_t length = probe.ContentLength();
+    if (length <= 0 || !EqualsIgnoreCase(probe.Headers().Get(kAcceptRanges), "bytes")) {
+        std::cout << "server doesn't offer byte ranges; downloading in one piece" << std::endl;
+        return Do(request);
+    }
+    segments = static_cast<int>(std::min<int64_t>(segments, std::max<int64_t>(1, length / kMinSegment)));
+    if (segments <= 1)
+        return Do(request);
+    // The ranges go straight to wherever the HEAD was redirected.
+    Request located = Redirected(request, last_uri_, 307);
+
+    std::string path = LocalPath(uri);
+    int fd = open(("./" + path).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        std::cout << "Failed to open " << path << ": " << strerror(errno) << std::endl;
+        return Response();
+    }
+    if (fallocate(fd, 0, 0, length) == -1 && ftruncate(fd, length) == -1) {
+        std::cout << "Failed to size " << path << ": " << strerror(errno) << std::endl;
+        close(fd);
+        return Response();
+    }
+
+    struct Segment {
+      int64_t start;
+      int64_t end;   // inclusive, as in the Range header
+      int64_t done = 0;
+      int attempts = 0;
+    };
+    std::vector<Segment> ranges;
+    int64_t step = (length + segments - 1) / segments;
+    for (int64_t start = 0; start < length; start += step)
+        ranges.push_back({start, std::min(length, start + step) - 1});
+
+    Fetcher fetcher(ranges.size(), ranges.size());
+    fetcher.SetResolver(resolver_);
+    std::vector<std::unique_ptr<FileSink>> sinks;
+    bool failed = false;
+
+    std::function<void(size_t)> fetch = [&](size_t i) {
+        Segment& seg = ranges[i];
+        int64_t from = seg.start + seg.done;
+        Request part = located;
+        part.AddHeader("Range", "bytes=" + std::to_string(from) + "-" + std::to_string(seg.end));
+        sinks.emplace_back(new FileSink(fd, from, seg.end - from + 1, &throughput_));
+        FileSink* sink = sinks.back().get();
+        ++seg.attempts;
+
+        fetcher.Add(part, sink, [&, i, sink](const FetchResult& result) {
+            Segment& seg = ranges[i];
+            seg.done += sink->Written();
+            if (result.OK() && result.status == 206 && seg.start + seg.done == seg.end + 1)
+                return;
+            std::cout << "range " << seg.start << "-" << seg.end << " stopped at " << seg.start + seg.done
+                      << ": " << (result.OK() ? "status " + std::to_string(result.status) : result.error)
+                      << std::endl;
+            // A server that answers with anything but 206 ignored the range;
+            // retrying won't change its mind.
+            if (result.OK() && result.status != 206)
+                failed = true;
+            else if (seg.attempts >= kSegmentAttempts)
+                failed = true;
+            else
+                fetch(i);
+        });
+    };
+    for (size_t i = 0; i < ranges.size(); ++i)
+        fetch(i);
+
+    if (!fetcher.Run())
+        failed = true;
+
+    int64_t total = 0;
+    for (const auto& seg : ranges)
+        total += seg.done;
+    struct stat sb;
+    if (fstat(fd, &sb) == -1 || sb.st_size != length)
+        failed = true;
+    close(fd);
+
+    if (failed || total != length) {
+        std::cout << "segmented download of " << path << " incomplete: " << total << " of " << length
+                  << " bytes" << std::endl;
+        probe.SetStatusCode(-1);
+        return probe;
+    }
+
+    std::cout << "wrote file " << path << " in " << ranges.size() << " segments" << std::endl;
+    probe.SetRecvBytes(total);
+    return probe;
+}
+
+}  // namespace http
@@ -0,0 +1,103 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_CLIENT_H_
+#define CODE_HTTPCLIENT_CLIENT_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "dialer.h"
+#include "message.h"
+#include "pool.h"
+#include "resolver.h"
+#include "sink.h"
+#include "timing.h"
+
+namespace http {
+
+// Where a body fetched from uri is written: its path, relative to the
+// current directory, or index.html for the root.
+std::string LocalPath(const URI& uri);
+
+class Client {
+ public:
+  typedef std::function<void(size_t, const Response&)> ManyCallback;
+
+  Client() {}
+  Client(size_t max_per_host, std::chrono::seconds idle_timeout) : pool_{max_per_host, idle_timeout} {}
+
+  int Connect(const std::string&, const std::string&);
+  Response Do(const Request&);
+  // Sends request and hands the body to sink as it arrives instead of
+  // writing a file. The cache and resuming don't apply; compression does.
+  Response Do(const Request&, BodySink* sink);
+  std::vector<Response> DoMany(const std::vector<Request>&, ManyCallback done = nullptr);
+  Response DownloadSegmented(const Request&, int);
+  const Throughput& Stats() const { return throughput_; }
+  // Where the last request spent its time, and the spread over all of
+  // them.
+  const RequestTiming& LastTiming() const { return timing_; }
+  const PhaseHistograms& Histograms() const { return histograms_; }
+  void SetResolver(Resolver* resolver) { resolver_ = resolver; }
+  void SetDialer(const Dialer& dialer) { dialer_ = dialer; }
+  // Ask for gzip or deflate bodies and decode them on the way to disk.
+  void SetCompression(bool compression) { compression_ = compression; }
+  // Answer GETs from cache where possible. The cache must outlive the
+  // client; nullptr turns caching off.
+  void SetCache(DiskCache* cache) { cache_ = cache; }
+  // Pick up interrupted GETs where they stopped instead of starting over.
+  void SetResume(bool resume) { resume_ = resume; }
+  // Follow at most hops redirects per request; 0 doesn't follow them.
+  void SetMaxRedirects(int hops) { max_redirects_ = hops; }
+  // Where the last Do ended up after any redirects.
+  const URI& LastUri() const { return last_uri_; }
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  // Body runs shorter than this go through recv; the extra splice
+  // syscalls aren't worth it.
+  static constexpr size_t kSpliceMin = 64 * 1024;
+  // Size of the pooled buffer responses are read into.
+  static constexpr size_t kRecvSize = 64 * 1024;
+  // Segmented downloads don't split below this many bytes per range, and
+  // give up on a range after this many failed attempts.
+  static constexpr int64_t kMinSegment = 1024 * 1024;
+  static constexpr int kSegmentAttempts = 5;
+  // DoMany keeps at most this many requests outstanding on a connection,
+  // and gives up after this many connections in a row answer nothing.
+  static constexpr size_t kPipelineDepth = 16;
+  static constexpr int kPipelineAttempts = 3;
+  static constexpr int kMaxRedirects = 10;
+  // How long to wait for 100 Continue before sending the body regardless.
+  static constexpr std::chrono::milliseconds kContinueWait{1000};
+
+  Response Follow(const Request&, BodySink*);
+  Response Once(const Request&, const std::string&);
+  Response Fetch(const Request&, const std::string&, BodySink* = nullptr);
+  bool RoundTrip(const Request&, const std::string&, BodySink*, int64_t, Response*, bool*);
+  bool ReadResponse(const Request&, const std::string&, BodySink*, int64_t, std::string*, Response*, bool*, bool*);
+  bool AwaitContinue(std::string*);
+  bool SendBody(const Request&);
+
+  ConnectionPool pool_;
+  Resolver* resolver_ = &Resolver::Default();
+  Dialer dialer_;
+  bool compression_ = false;
+  DiskCache* cache_ = nullptr;
+  bool resume_ = false;
+  int max_redirects_ = kMaxRedirects;
+  URI last_uri_;
+  Connection conn_;
+  Throughput throughput_;
+  RequestTiming timing_;
+  PhaseHistograms histograms_;
+  Clock::time_point sent_at_;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_CLIENT_H_
@@ -0,0 +1,134 @@
+// Copyright hopkiw 2026
+#include "dialer.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+#include <vector>
+
+namespace http {
+
+void Dialer::Interleave(std::vector<Address>* addrs) {
+    if (addrs->empty())
+        return;
+    int first = addrs->front().family;
+    std::deque<Address> primary, secondary;
+    for (const Address& addr : *addrs) {
+        if (addr.family == first)
+            primary.push_back(addr);
+        else
+            secondary.push_back(addr);
+    }
+
+    addrs->clear();
+    while (!primary.empty() || !secondary.empty()) {
+        if (!primary.empty()) {
+            addrs->push_back(primary.front());
+            primary.pop_front();
+        }
+        if (!secondary.empty()) {
+            addrs->push_back(secondary.front());
+            secondary.pop_front();
+        }
+    }
+}
+
+int Dialer::Dial(const std::vector<Address>& addrs) const {
+    typedef std::chrono::steady_clock Clock;
+
+    struct Attempt {
+      int fd;
+      Clock::time_point deadline;
+    };
+
+    auto now = Clock::now();
+    auto give_up = now + total_timeout_;
+    auto next_start = now;
+    size_t next = 0;
+    std::vector<Attempt> attempts;
+    int winner = -1;
+
+    while (winner == -1 && now < give_up) {
+        // Start the next candidate when its turn comes, or at once if
+        // nothing is in flight.
+        while (next < addrs.size() && (now >= next_start || attempts.empty())) {
+            const Address& addr = addrs[next++];
+            int fd = socket(addr.family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (fd == -1)
+                continue;
+            if (connect(fd, addr.SockAddr(), addr.len) == 0) {
+                winner = fd;
+                break;
+            }
+            if (errno != EINPROGRESS) {
+                close(fd);
+                continue;
+            }
+            attempts.push_back(Attempt{fd, now + attempt_timeout_});
+            next_start = now + stagger_;
+        }
+        if (winner != -1 || attempts.empty())
+            break;
+
+        auto wake = give_up;
+        if (next < addrs.size())
+            wake = std::min(wake, next_start);
+        for (const Attempt& a : attempts)
+            wake = std::min(wake, a.deadline);
+        int wait = std::chrono::duration_cast<std::chrono::milliseconds>(wake - now).count();
+
+        std::vector<struct pollfd> fds;
+        for (const Attempt& a : attempts)
+            fds.push_back(pollfd{a.fd, POLLOUT, 0});
+        int n = poll(fds.data(), fds.size(), std::max(wait, 0));
+        if (n == -1 && errno != EINTR)
+            break;
+        now = Clock::now();
+
+        // Settle finished and expired attempts. Any failure moves the next
+        // start up to now instead of waiting out the stagger.
+        std::vector<Attempt> pending;
+        for (size_t i = 0; i < attempts.size(); ++i) {
+            bool failed = false;
+            if (n > 0 && fds[i].revents != 0) {
+                int err = 0;
+                socklen_t len = sizeof(err);
+                getsockopt(attempts[i].fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                if (err == 0 && winner == -1) {
+                    winner = attempts[i].fd;
+                    continue;
+                }
+                failed = true;
+            } else if (attempts[i].deadline <= now) {
+                failed = true;
+            }
+
+            if (failed) {
+                close(attempts[i].fd);
+                next_start = now;
+            } else {
+                pending.push_back(attempts[i]);
+            }
+        }
+        attempts.swap(pending);
+    }
+
+    for (const Attempt& a : attempts) {
+        if (a.fd != winner)
+            close(a.fd);
+    }
+    if (winner == -1)
+        return -1;
+
+    // The rest of the client does blocking I/O on this socket.
+    int flags = fcntl(winner, F_GETFL);
+    fcntl(winner, F_SETFL, flags & ~O_NONBLOCK);
+    return winner;
+}
+
+}  // namespace http
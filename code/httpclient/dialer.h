@@ -0,0 +1,44 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_DIALER_H_
+#define CODE_HTTPCLIENT_DIALER_H_
+
+#include <chrono>
+#include <vector>
+
+#include "resolver.h"
+
+namespace http {
+
+// Connects to the first of several candidate addresses that answers, in
+// the style of RFC 8305 ("happy eyeballs"). Candidates are ordered so
+// IPv6 and IPv4 alternate, and attempts are started one stagger apart
+// without waiting for the previous one to finish; an attempt that fails
+// starts the next one straight away. Each attempt is abandoned after
+// attempt_timeout and the whole dial after total_timeout, so one
+// blackholed address can't hold up the others.
+class Dialer {
+ public:
+  Dialer() : Dialer(std::chrono::milliseconds(250), std::chrono::seconds(10), std::chrono::seconds(30)) {}
+  Dialer(std::chrono::milliseconds stagger, std::chrono::milliseconds attempt_timeout,
+         std::chrono::milliseconds total_timeout)
+      : stagger_{stagger}, attempt_timeout_{attempt_timeout}, total_timeout_{total_timeout} {}
+
+  // Returns a connected, blocking socket, or -1 if no candidate answered.
+  int Dial(const std::vector<Address>&) const;
+
+  // Reorders addrs so address families alternate, keeping the resolver's
+  // order within each family and starting with the family it put first.
+  static void Interleave(std::vector<Address>*);
+
+  std::chrono::milliseconds Stagger() const { return stagger_; }
+  std::chrono::milliseconds AttemptTimeout() const { return attempt_timeout_; }
+
+ private:
+  std::chrono::milliseconds stagger_;
+  std::chrono::milliseconds attempt_timeout_;
+  std::chrono::milliseconds total_timeout_;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_DIALER_H_
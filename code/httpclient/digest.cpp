@@ -0,0 +1,382 @@
+// Copyright hopkiw 2026
+#include "digest.h"
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstring>
+
+namespace http {
+
+namespace {
+
+constexpr uint32_t kSha256Init[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+alignas(16) constexpr uint32_t kSha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+// Slicing-by-8 tables for the reflected Castagnoli polynomial: entry
+// [k][b] is the CRC of byte b followed by k zero bytes.
+struct Crc32cTables {
+  uint32_t table[8][256];
+};
+
+constexpr Crc32cTables MakeCrc32cTables() {
+    Crc32cTables tables{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78 : 0);
+        tables.table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (int k = 1; k < 8; ++k)
+            tables.table[k][i] = (tables.table[k - 1][i] >> 8) ^ tables.table[0][tables.table[k - 1][i] & 0xFF];
+    }
+    return tables;
+}
+
+constexpr Crc32cTables kCrc32c = MakeCrc32cTables();
+
+typedef void (*Sha256Fn)(uint32_t*, const unsigned char*, size_t);
+typedef uint32_t (*Crc32cFn)(uint32_t, const char*, size_t);
+
+// Picked once, on first use.
+Sha256Fn Sha256Impl() {
+    static const Sha256Fn fn = internal::HasShaNi() ? internal::Sha256BlocksNi : internal::Sha256Blocks;
+    return fn;
+}
+
+Crc32cFn Crc32cImpl() {
+    static const Crc32cFn fn = internal::HasSse42() ? internal::Crc32cUpdateSse42 : internal::Crc32cUpdate;
+    return fn;
+}
+
+std::string Hex(const unsigned char* data, size_t len) {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string hex(len * 2, '0');
+    for (size_t i = 0; i < len; ++i) {
+        hex[2 * i] = kDigits[data[i] >> 4];
+        hex[2 * i + 1] = kDigits[data[i] & 0xF];
+    }
+    return hex;
+}
+
+inline uint32_t Rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+inline uint32_t LoadBigEndian(const unsigned char* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+}  // namespace
+
+namespace internal {
+
+#if defined(__x86_64__)
+bool HasShaNi() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (ebx & bit_SHA) && __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("ssse3");
+}
+
+bool HasSse42() {
+    return __builtin_cpu_supports("sse4.2");
+}
+#else
+bool HasShaNi() {
+    return false;
+}
+
+bool HasSse42() {
+    return false;
+}
+#endif
+
+void Sha256Blocks(uint32_t state[8], const unsigned char* data, size_t blocks) {
+    for (; blocks > 0; --blocks, data += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i)
+            w[i] = LoadBigEndian(data + 4 * i);
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = h + (Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25)) + ((e & f) ^ (~e & g)) + kSha256K[i] + w[i];
+            uint32_t t2 = (Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(__x86_64__)
+// The SHA extensions keep the state as two vectors, ABEF and CDGH, and do
+// two rounds per sha256rnds2. Each group of four rounds takes the next four
+// words of the message schedule, which sha256msg1/msg2 extend from the
+// previous sixteen.
+__attribute__((target("sha,sse4.1,ssse3")))
+void Sha256BlocksNi(uint32_t state[8], const unsigned char* data, size_t blocks) {
+    const __m128i kByteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4])), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);   // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);         // CDGH
+
+    for (; blocks > 0; --blocks, data += 64) {
+        __m128i abef = state0;
+        __m128i cdgh = state1;
+        __m128i w[4];
+#pragma GCC unroll 16
+        for (int i = 0; i < 16; ++i) {
+            __m128i& words = w[i % 4];
+            if (i < 4) {
+                words = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)), kByteSwap);
+            } else {
+                const __m128i& prev = w[(i + 3) % 4];
+                words = _mm_sha256msg1_epu32(words, w[(i + 1) % 4]);
+                words = _mm_add_epi32(words, _mm_alignr_epi8(prev, w[(i + 2) % 4], 4));
+                words = _mm_sha256msg2_epu32(words, prev);
+            }
+            __m128i msg = _mm_add_epi32(words, _mm_load_si128(reinterpret_cast<const __m128i*>(&kSha256K[4 * i])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+        }
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);      // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);   // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);  // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);     // HGFE
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+__attribute__((target("sse4.2")))
+uint32_t Crc32cUpdateSse42(uint32_t crc, const char* data, size_t len) {
+    uint64_t crc64 = crc;
+    for (; len >= 8; len -= 8, data += 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; len > 0; --len)
+        crc = _mm_crc32_u8(crc, static_cast<unsigned char>(*data++));
+    return crc;
+}
+#else
+void Sha256BlocksNi(uint32_t state[8], const unsigned char* data, size_t blocks) {
+    Sha256Blocks(state, data, blocks);
+}
+
+uint32_t Crc32cUpdateSse42(uint32_t crc, const char* data, size_t len) {
+    return Crc32cUpdate(crc, data, len);
+}
+#endif
+
+uint32_t Crc32cUpdate(uint32_t crc, const char* data, size_t len) {
+    const auto& t = kCrc32c.table;
+    // Eight bytes at a time, which relies on loading them little-endian.
+    if constexpr (std::endian::native == std::endian::little) {
+        for (; len >= 8; len -= 8, data += 8) {
+            uint64_t word;
+            memcpy(&word, data, 8);
+            word ^= crc;
+            crc = t[7][word & 0xFF] ^ t[6][(word >> 8) & 0xFF] ^ t[5][(word >> 16) & 0xFF] ^
+                  t[4][(word >> 24) & 0xFF] ^ t[3][(word >> 32) & 0xFF] ^ t[2][(word >> 40) & 0xFF] ^
+                  t[1][(word >> 48) & 0xFF] ^ t[0][word >> 56];
+        }
+    }
+    for (; len > 0; --len)
+        crc = (crc >> 8) ^ t[0][(crc ^ static_cast<unsigned char>(*data++)) & 0xFF];
+    return crc;
+}
+
+}  // namespace internal
+
+void Sha256::Reset() {
+    std::copy(kSha256Init, kSha256Init + 8, state_);
+    length_ = 0;
+    used_ = 0;
+}
+
+// Whole blocks go straight from data; only the ragged ends are copied.
+void Sha256::Update(const char* data, size_t len) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    length_ += len;
+    if (used_ > 0) {
+        size_t n = std::min(len, sizeof(block_) - used_);
+        memcpy(block_ + used_, p, n);
+        used_ += n;
+        p += n;
+        len -= n;
+        if (used_ < sizeof(block_))
+            return;
+        Sha256Impl()(state_, block_, 1);
+        used_ = 0;
+    }
+    if (len >= 64) {
+        Sha256Impl()(state_, p, len / 64);
+        p += len / 64 * 64;
+        len %= 64;
+    }
+    memcpy(block_, p, len);
+    used_ = len;
+}
+
+std::string Sha256::Final() {
+    uint64_t bits = length_ * 8;
+    block_[used_++] = 0x80;
+    if (used_ > 56) {
+        memset(block_ + used_, 0, sizeof(block_) - used_);
+        Sha256Impl()(state_, block_, 1);
+        used_ = 0;
+    }
+    memset(block_ + used_, 0, 56 - used_);
+    for (int i = 0; i < 8; ++i)
+        block_[56 + i] = static_cast<unsigned char>(bits >> (56 - 8 * i));
+    Sha256Impl()(state_, block_, 1);
+
+    unsigned char digest[32];
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 4; ++j)
+            digest[4 * i + j] = static_cast<unsigned char>(state_[i] >> (24 - 8 * j));
+    }
+    return Hex(digest, sizeof(digest));
+}
+
+bool Sha256::Accelerated() {
+    return Sha256Impl() == internal::Sha256BlocksNi;
+}
+
+void Crc32c::Update(const char* data, size_t len) {
+    crc_ = Crc32cImpl()(crc_, data, len);
+}
+
+std::string Crc32c::Final() const {
+    uint32_t value = Value();
+    unsigned char bytes[4] = {static_cast<unsigned char>(value >> 24), static_cast<unsigned char>(value >> 16),
+                              static_cast<unsigned char>(value >> 8), static_cast<unsigned char>(value)};
+    return Hex(bytes, sizeof(bytes));
+}
+
+bool Crc32c::Accelerated() {
+    return Crc32cImpl() == internal::Crc32cUpdateSse42;
+}
+
+bool Digests::Parse(std::string_view field) {
+    size_t eq = field.find('=');
+    if (eq == std::string_view::npos)
+        return false;
+    std::string_view name = field.substr(0, eq);
+    std::string hex(field.substr(eq + 1));
+    if (!std::all_of(hex.begin(), hex.end(), [](unsigned char c) { return isxdigit(c); }))
+        return false;
+    std::transform(hex.begin(), hex.end(), hex.begin(), [](unsigned char c) { return tolower(c); });
+    if (name == "sha256" && hex.length() == 64) {
+        sha256 = hex;
+        return true;
+    }
+    if (name == "crc32c" && hex.length() == 8) {
+        crc32c = hex;
+        return true;
+    }
+    return false;
+}
+
+void DigestSink::Head(const Response& res) {
+    checked_ = res.OK();
+    error_ = checked_ ? "" : "HTTP status " + std::to_string(res.StatusCode()) + ", body not checked";
+    next_->Head(res);
+}
+
+bool DigestSink::Begin(int64_t length) {
+    sha256_.Reset();
+    crc32c_.Reset();
+    actual_ = Digests();
+    length_ = length;
+    received_ = 0;
+    verified_ = false;
+    return next_->Begin(length);
+}
+
+bool DigestSink::Write(const char* data, size_t len) {
+    if (!checked_)
+        return next_->Write(data, len);
+    received_ += len;
+    if (!expected_.sha256.empty())
+        sha256_.Update(data, len);
+    if (!expected_.crc32c.empty())
+        crc32c_.Update(data, len);
+    return next_->Write(data, len);
+}
+
+bool DigestSink::Finish() {
+    if (!next_->Finish()) {
+        error_ = next_->Error();
+        return false;
+    }
+    if (!checked_)
+        return true;
+    if (length_ >= 0 && received_ != length_) {
+        error_ = "body incomplete, not verified";
+        return false;
+    }
+    if (!expected_.sha256.empty())
+        actual_.sha256 = sha256_.Final();
+    if (!expected_.crc32c.empty())
+        actual_.crc32c = crc32c_.Final();
+    verified_ = actual_.sha256 == expected_.sha256 && actual_.crc32c == expected_.crc32c;
+    if (verified_)
+        return true;
+
+    if (actual_.sha256 != expected_.sha256)
+        error_ = "sha256 mismatch: expected " + expected_.sha256 + ", got " + actual_.sha256;
+    else
+        error_ = "crc32c mismatch: expected " + expected_.crc32c + ", got " + actual_.crc32c;
+    if (!path_.empty() && unlink(path_.c_str()) == 0)
+        error_ += "; removed " + path_;
+    return false;
+}
+
+}  // namespace http
@@ -0,0 +1,117 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_DIGEST_H_
+#define CODE_HTTPCLIENT_DIGEST_H_
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "message.h"
+#include "sink.h"
+
+namespace http {
+
+// SHA-256 (FIPS 180-4), using the SHA extensions where the CPU has them.
+class Sha256 {
+ public:
+  Sha256() { Reset(); }
+  void Reset();
+  void Update(const char* data, size_t len);
+  // The digest of everything passed to Update, in lowercase hex. Reset
+  // before using the object again.
+  std::string Final();
+
+  static bool Accelerated();
+
+ private:
+  uint32_t state_[8];
+  uint64_t length_;
+  unsigned char block_[64];
+  size_t used_;
+};
+
+// CRC-32C (Castagnoli), using the SSE4.2 crc32 instruction where the CPU
+// has it.
+class Crc32c {
+ public:
+  void Reset() { crc_ = 0xFFFFFFFF; }
+  void Update(const char* data, size_t len);
+  uint32_t Value() const { return ~crc_; }
+  // Value in lowercase hex, 8 digits.
+  std::string Final() const;
+
+  static bool Accelerated();
+
+ private:
+  uint32_t crc_ = 0xFFFFFFFF;
+};
+
+// The digests a body is expected to have, in lowercase hex. Empty ones
+// aren't checked.
+struct Digests {
+  std::string sha256;
+  std::string crc32c;
+
+  bool Empty() const { return sha256.empty() && crc32c.empty(); }
+  // Takes one "sha256=<hex>" or "crc32c=<hex>". False if it's neither or
+  // the hex is the wrong length.
+  bool Parse(std::string_view field);
+};
+
+// Computes the expected digests of a body on its way to next, over the same
+// buffers, so the file doesn't have to be read back to check it. A body
+// that doesn't match fails in Finish, and the file at path, if given, is
+// removed so it can't pass for a good copy. A body shorter than its
+// Content-Length fails without being checked. Only the body of a 2xx is
+// the resource the digests are for; other bodies pass through. The digests
+// need every byte, so nothing is spliced past them.
+class DigestSink : public BodySink {
+ public:
+  DigestSink(BodySink* next, const Digests& expected, const std::string& path = "")
+      : next_{next}, expected_{expected}, path_{path} {}
+
+  void Head(const Response&) override;
+  bool Begin(int64_t) override;
+  bool Write(const char*, size_t) override;
+  bool Finish() override;
+  std::string Error() const override { return error_; }
+
+  // Whether the body matched; false until Finish, and for a response that
+  // isn't a 2xx, whose body is passed on unchecked.
+  bool Verified() const { return verified_; }
+  const Digests& Actual() const { return actual_; }
+
+ private:
+  BodySink* next_;
+  Digests expected_;
+  std::string path_;
+  Digests actual_;
+  Sha256 sha256_;
+  Crc32c crc32c_;
+  int64_t length_ = -1;
+  int64_t received_ = 0;
+  bool checked_ = true;
+  bool verified_ = false;
+  std::string error_;
+};
+
+namespace internal {
+
+// The implementations behind Sha256 and Crc32c, for benchmarks. The
+// accelerated ones may only be called if the matching Has function says
+// the CPU supports them.
+bool HasShaNi();
+bool HasSse42();
+void Sha256Blocks(uint32_t state[8], const unsigned char* data, size_t blocks);
+void Sha256BlocksNi(uint32_t state[8], const unsigned char* data, size_t blocks);
+uint32_t Crc32cUpdate(uint32_t crc, const char* data, size_t len);
+uint32_t Crc32cUpdateSse42(uint32_t crc, const char* data, size_t len);
+
+}  // namespace internal
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_DIGEST_H_
@@ -0,0 +1,647 @@
+// Copyright hopkiw 2026
+#include "fetcher.h"
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace http {
+
+Fetcher::~Fetcher() {
+    for (auto& entry : active_) {
+        Transfer* t = entry.second.get();
+        for (const Attempt& a : t->attempts)
+            close(a.fd);
+        pool_.Release(&t->conn, false);
+    }
+    if (epfd_ != -1)
+        close(epfd_);
+}
+
+namespace {
+
+std::string Url(const URI& uri) {
+    return uri.Protocol + (uri.Protocol.empty() ? "" : "://") + uri.Host + (uri.Port.empty() ? "" : ":" + uri.Port)
+         + uri.Path + uri.QueryString;
+}
+
+}  // namespace
+
+// Queues a request. The body goes to sink, which must stay alive until
+// done has been called. Returns an id for Cancel.
+uint64_t Fetcher::Add(const Request& request, BodySink* sink, Callback done) {
+    const URI& uri = request.Uri();
+    std::unique_ptr<Transfer> t(new Transfer(request, sink, done));
+    t->id = next_id_++;
+    t->key = ConnectionPool::Key(uri.Host, uri.Port.empty() ? "80" : uri.Port);
+    if (!t->request.HasHeader("Connection"))
+        t->request.AddHeader("Connection", "keep-alive");
+    t->out.Add(t->request);
+    uint64_t id = t->id;
+    waiting_[t->key].push_back(std::move(t));
+    return id;
+}
+
+// Runs until every queued request has finished. Returns false if the event
+// loop could not be set up.
+bool Fetcher::Run() {
+    while (Pending()) {
+        if (!Poll(std::chrono::milliseconds(1000)))
+            return false;
+    }
+    return true;
+}
+
+bool Fetcher::Poll(std::chrono::milliseconds timeout) {
+    if (!Setup())
+        return false;
+    Launch();
+    Unpause();
+    if (scheduler_ != nullptr && (!paused_.empty() || !waiting_.empty()))
+        timeout = std::chrono::ceil<std::chrono::milliseconds>(scheduler_->Wait(Clock::now(), timeout));
+    if (active_.empty()) {
+        // Whatever is left is waiting for the scheduler's go-ahead.
+        if (!waiting_.empty())
+            std::this_thread::sleep_for(timeout);
+        return true;
+    }
+    // Wake in time to start the next connect of a race, or give one up.
+    auto now = Clock::now();
+    for (const auto& entry : active_) {
+        const Transfer* t = entry.second.get();
+        if (t->phase == kConnecting)
+            timeout = std::clamp(std::chrono::ceil<std::chrono::milliseconds>(t->deadline - now),
+                                 std::chrono::milliseconds(0), timeout);
+    }
+    if (ring_.Ready())
+        return PollRing(timeout);
+
+    struct epoll_event events[256];
+    int n = epoll_wait(epfd_, events, 256, timeout.count());
+    if (n == -1) {
+        if (errno == EINTR)
+            return true;
+        std::cout << "epoll_wait failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    for (int i = 0; i < n; ++i) {
+        auto it = active_.find(events[i].data.u64);
+        if (it != active_.end())
+            OnEvent(it->second.get());
+    }
+    Expire();
+    Launch();
+    return true;
+}
+
+// Poll for io_uring. Everything queued since the last turn goes to the
+// kernel in the same call that waits for completions.
+bool Fetcher::PollRing(std::chrono::milliseconds timeout) {
+    if (!ring_.Wait(timeout)) {
+        std::cout << "io_uring_enter failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    struct io_uring_cqe cqe;
+    while (ring_.Pop(&cqe))
+        OnCompletion(cqe);
+    Expire();
+    Launch();
+    return true;
+}
+
+// Picks the backend on first use.
+bool Fetcher::Setup() {
+    if (want_uring_ && !ring_.Ready()) {
+        if (!ring_.Init(kRingEntries, kRingBuffers, kRingBufferSize))
+            std::cout << "io_uring isn't available; using epoll" << std::endl;
+        want_uring_ = false;
+    }
+    if (ring_.Ready() || epfd_ != -1)
+        return true;
+    if ((epfd_ = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+        std::cout << "Failed to create epoll instance" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Fetcher::Cancel(uint64_t id, const std::string& error) {
+    auto it = active_.find(id);
+    if (it != active_.end()) {
+        Complete(it->second.get(), error);
+        return true;
+    }
+    for (auto host = waiting_.begin(); host != waiting_.end(); ++host) {
+        auto& queue = host->second;
+        for (auto q = queue.begin(); q != queue.end(); ++q) {
+            if ((*q)->id != id)
+                continue;
+            std::unique_ptr<Transfer> t = std::move(*q);
+            queue.erase(q);
+            if (queue.empty())
+                waiting_.erase(host);
+            FetchResult result;
+            result.url = Url(t->request.Uri());
+            result.error = error;
+            t->done(result);
+            return true;
+        }
+    }
+    return false;
+}
+
+// How many requests may be in flight at once.
+size_t Fetcher::Limit() {
+    if (scheduler_ == nullptr)
+        return max_total_;
+    return scheduler_->Concurrency(max_total_, active_.size(), paused_.size(), Clock::now());
+}
+
+// Starts waiting requests, one host at a time in turn, until the global
+// limit is reached or every host with work is at its own limit (or out of
+// the scheduler's request tokens). Each pass picks up after the host served
+// last, so when the global limit cuts a pass short the same hosts aren't
+// always the ones left out.
+void Fetcher::Launch() {
+    size_t limit = Limit();
+    auto now = Clock::now();
+    bool progress = true;
+    while (progress && active_.size() < limit) {
+        progress = false;
+        auto it = waiting_.upper_bound(last_host_);
+        for (size_t n = waiting_.size(); n > 0 && active_.size() < limit; --n) {
+            if (it == waiting_.end())
+                it = waiting_.begin();
+            if (per_host_[it->first] < max_per_host_ &&
+                (scheduler_ == nullptr || scheduler_->Admit(it->first, now))) {
+                std::unique_ptr<Transfer> t = std::move(it->second.front());
+                it->second.pop_front();
+                last_host_ = it->first;
+                Transfer* raw = t.get();
+                raw->started = Clock::now();
+                active_[raw->id] = std::move(t);
+                Start(raw);
+                progress = true;
+            }
+            if (it->second.empty())
+                it = waiting_.erase(it);
+            else
+                ++it;
+        }
+    }
+}
+
+void Fetcher::Start(Transfer* t) {
+    ++per_host_[t->key];
+    t->deadline = std::chrono::steady_clock::now() + timeout_;
+
+    // Only a body held in memory goes out with the head.
+    if (t->request.Body() == Request::kFileBody || t->request.Body() == Request::kProducedBody) {
+        Complete(t, "only bodies held in memory can be sent from the Fetcher");
+        return;
+    }
+
+    if (!pool_.Acquire(t->key, &t->conn)) {
+        // Only happens if pooled connections outnumber our own limit.
+        Complete(t, "too many connections to " + t->key);
+        return;
+    }
+
+    t->reused = t->conn.fd != -1;
+    t->timing = RequestTiming();
+    t->timing.reused = t->reused;
+    t->first_byte = Clock::time_point();
+    if (t->reused) {
+        t->phase = kSending;
+        Watch(t, EPOLL_CTL_ADD, EPOLLOUT);
+        return;
+    }
+
+    const URI& uri = t->request.Uri();
+    t->addrs.clear();
+    t->next_addr = 0;
+    auto start = Clock::now();
+    int err = resolver_->Resolve(uri.Host, uri.Port.empty() ? "80" : uri.Port, AF_UNSPEC, &t->addrs);
+    t->mark = Clock::now();
+    t->timing.phase[kResolve] = t->mark - start;
+    if (err != 0) {
+        Complete(t, "error looking up host");
+        return;
+    }
+    Dialer::Interleave(&t->addrs);
+    t->next_dial = t->mark;
+    if (!Dial(t))
+        Complete(t, "error connecting");
+}
+
+// Moves the race between t's candidate addresses along, as Dialer::Dial
+// does for the blocking Client (RFC 8305): candidates alternate between
+// IPv6 and IPv4, each starts one stagger after the last without waiting
+// for it, or at once when an attempt fails, and an attempt is given up
+// after the dialer's attempt timeout. The first to connect wins, the rest
+// are closed and the request is sent. Called when t is started, when one
+// of its sockets is ready and when its deadline passes. Returns false once
+// every candidate has failed.
+bool Fetcher::Dial(Transfer* t) {
+    auto now = Clock::now();
+    std::vector<struct pollfd> fds;
+    for (const Attempt& a : t->attempts)
+        fds.push_back(pollfd{a.fd, POLLOUT, 0});
+    if (!fds.empty() && poll(fds.data(), fds.size(), 0) == -1)
+        fds.assign(fds.size(), pollfd{-1, 0, 0});
+
+    int winner = -1;
+    std::vector<Attempt> pending;
+    for (size_t i = 0; i < t->attempts.size(); ++i) {
+        const Attempt& a = t->attempts[i];
+        if (fds[i].revents != 0) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(a.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err == 0 && winner == -1) {
+                winner = a.fd;
+                continue;
+            }
+        } else if (a.deadline > now) {
+            pending.push_back(a);
+            continue;
+        }
+        // Failed or out of time; the next candidate needn't wait its turn.
+        close(a.fd);
+        t->next_dial = now;
+    }
+    t->attempts.swap(pending);
+
+    if (winner != -1) {
+        Abandon(t);
+        t->conn.fd = winner;
+        t->phase = kSending;
+        t->deadline = now + timeout_;
+        t->timing.phase[kConnect] = now - t->mark;
+        Send(t);
+        return true;
+    }
+
+    while (t->next_addr < t->addrs.size() && (now >= t->next_dial || t->attempts.empty())) {
+        const Address& addr = t->addrs[t->next_addr++];
+        int fd = socket(addr.family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd == -1)
+            continue;
+        // Even a connect that succeeds at once is picked up by the watch.
+        if (connect(fd, addr.SockAddr(), addr.len) == -1 && errno != EINPROGRESS) {
+            close(fd);
+            continue;
+        }
+        t->attempts.push_back(Attempt{fd, now + std::min<Clock::duration>(dialer_.AttemptTimeout(), timeout_)});
+        t->next_dial = now + dialer_.Stagger();
+        WatchConnect(t, fd);
+    }
+    if (t->attempts.empty())
+        return false;
+
+    t->phase = kConnecting;
+    t->deadline = t->next_addr < t->addrs.size() ? t->next_dial : Clock::time_point::max();
+    for (const Attempt& a : t->attempts)
+        t->deadline = std::min(t->deadline, a.deadline);
+    return true;
+}
+
+// Closes the connects t still has racing. Closing a socket takes it off
+// the epoll set; on the ring, their polls are cancelled.
+void Fetcher::Abandon(Transfer* t) {
+    if (t->attempts.empty())
+        return;
+    if (ring_.Ready())
+        Unwatch(t);
+    for (const Attempt& a : t->attempts)
+        close(a.fd);
+    t->attempts.clear();
+}
+
+// Waits for the socket to become writable (EPOLLOUT) or readable
+// (EPOLLIN). On the ring, writable is a one-shot poll and readable arms
+// the connection's multishot recv.
+void Fetcher::Watch(Transfer* t, int op, uint32_t events) {
+    if (ring_.Ready()) {
+        if (events & EPOLLIN)
+            ring_.RecvMultishot(t->conn.fd, Submitted(t, kRecvOp));
+        else
+            ring_.PollOut(t->conn.fd, Submitted(t, kPollOp));
+        return;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u64 = t->id;
+    epoll_ctl(epfd_, op, t->conn.fd, &ev);
+}
+
+// Waits for a racing connect on fd to finish. On the ring all of a
+// transfer's connects share one user data, so they can be cancelled
+// together.
+void Fetcher::WatchConnect(Transfer* t, int fd) {
+    if (ring_.Ready()) {
+        ring_.PollOut(fd, Submitted(t, kPollOp));
+        return;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLOUT;
+    ev.data.u64 = t->id;
+    epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev);
+}
+
+// Stops watching the socket, before it is closed or pooled. Completions
+// already on their way are ignored.
+void Fetcher::Unwatch(Transfer* t) {
+    if (!ring_.Ready()) {
+        epoll_ctl(epfd_, EPOLL_CTL_DEL, t->conn.fd, NULL);
+        return;
+    }
+    if (t->inflight != 0)
+        ring_.Cancel(t->inflight);
+    t->inflight = 0;
+    ++t->generation;
+}
+
+// The user data for a ring operation of t's, which is then the one in
+// progress.
+uint64_t Fetcher::Submitted(Transfer* t, Op op) {
+    t->inflight = t->id << 8 | (t->generation & 0x3f) << 2 | op;
+    return t->inflight;
+}
+
+void Fetcher::OnCompletion(const struct io_uring_cqe& cqe) {
+    auto it = active_.find(cqe.user_data >> 8);
+    Transfer* t = it == active_.end() ? nullptr : it->second.get();
+    if (t == nullptr || cqe.user_data != t->inflight) {
+        ring_.Recycle(cqe);
+        return;
+    }
+    // While connects race, each has a poll under the same user data.
+    if (!(cqe.flags & IORING_CQE_F_MORE) && t->phase != kConnecting)
+        t->inflight = 0;
+
+    switch (cqe.user_data & 3) {
+    case kPollOp:
+        OnEvent(t);
+        break;
+    case kSendOp:
+        t->deadline = std::chrono::steady_clock::now() + timeout_;
+        if (cqe.res > 0)
+            t->out.Advance(cqe.res);
+        OnSent(t, cqe.res > 0);
+        break;
+    case kRecvOp: {
+        t->deadline = std::chrono::steady_clock::now() + timeout_;
+        uint64_t id = t->id;
+        if (cqe.res == -ENOBUFS || (cqe.res == -ECANCELED && t->paused)) {
+            // Every buffer was taken, and they're free again by now; or
+            // Pause stopped the recv.
+        } else if (cqe.res < 0) {
+            errno = -cqe.res;
+            Received(t, -1, nullptr);
+        } else {
+            Received(t, cqe.res, cqe.res > 0 ? ring_.Buffer(cqe) : nullptr);
+        }
+        ring_.Recycle(cqe);
+        // The kernel ended the multishot recv while the response is still
+        // coming.
+        it = active_.find(id);
+        if (it != active_.end() && it->second->inflight == 0 && it->second->phase == kReceiving &&
+            !it->second->paused)
+            Watch(it->second.get(), EPOLL_CTL_MOD, EPOLLIN);
+        break;
+    }
+    }
+}
+
+void Fetcher::OnEvent(Transfer* t) {
+    t->deadline = std::chrono::steady_clock::now() + timeout_;
+
+    if (t->phase == kConnecting) {
+        if (!Dial(t))
+            Complete(t, "error connecting");
+        return;
+    }
+
+    if (t->phase == kSending)
+        Send(t);
+    else
+        Receive(t);
+}
+
+// Sends what's left of the request: right away with epoll, as a SENDMSG
+// on the ring with io_uring, finishing in OnSent either way.
+void Fetcher::Send(Transfer* t) {
+    if (t->out.Sent() == 0)
+        t->mark = Clock::now();
+    if (ring_.Ready()) {
+        t->out.Prepare(&t->msg);
+        ring_.SendMsg(t->conn.fd, &t->msg, Submitted(t, kSendOp));
+        return;
+    }
+    OnSent(t, t->out.Flush(t->conn.fd));
+}
+
+void Fetcher::OnSent(Transfer* t, bool ok) {
+    if (!ok) {
+        if (t->reused)
+            Retry(t);
+        else
+            Complete(t, "Failed to send message");
+        return;
+    }
+    if (!t->out.Done()) {
+        if (ring_.Ready())
+            Send(t);
+        return;
+    }
+
+    t->phase = kReceiving;
+    t->parser.reset(new ResponseParser(&t->res, t->request.Method() == "HEAD", t->sink));
+    Watch(t, EPOLL_CTL_MOD, EPOLLIN);
+}
+
+// Reads whatever the socket has. One recv (or splice) per wakeup keeps a
+// single fast connection from starving the others.
+void Fetcher::Receive(Transfer* t) {
+    ResponseParser* parser = t->parser.get();
+    ssize_t n;
+    bool spliced = false;
+
+    size_t want = buf_.Capacity();
+    if (scheduler_ != nullptr)
+        want = scheduler_->ReadSize(t->key, want, Clock::now());
+    size_t direct = parser->Direct();
+    if (direct >= kSpliceMin && t->sink->CanSplice()) {
+        n = t->sink->Splice(t->conn.fd, std::min(direct, want));
+        spliced = true;
+    } else {
+        n = recv(t->conn.fd, buf_.Data(), want, 0);
+    }
+
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return;
+    Received(t, n, spliced ? nullptr : buf_.Data());
+}
+
+// Takes the result of one read: n bytes at data, or n bytes spliced
+// straight to the sink if data is null; 0 at end of stream, -1 on error.
+void Fetcher::Received(Transfer* t, ssize_t n, const char* data) {
+    ResponseParser* parser = t->parser.get();
+    if (n == -1) {
+        if (t->reused && !parser->Started())
+            Retry(t);
+        else
+            Complete(t, "Failed to recv message");
+        return;
+    }
+
+    if (n > 0 && t->first_byte == Clock::time_point())
+        t->first_byte = Clock::now();
+    if (n > 0 && scheduler_ != nullptr)
+        scheduler_->Consumed(t->key, n, Clock::now());
+
+    if (n == 0) {
+        if (t->reused && !parser->Started())
+            Retry(t);
+        else if (!parser->Finish())
+            Complete(t, "Connection closed by remote host.");
+        else
+            Complete(t, "");
+        return;
+    }
+
+    if (data == nullptr) {
+        parser->Skip(n);
+    } else {
+        size_t used = parser->Feed(data, n);
+        if (parser->Failed()) {
+            Complete(t, "invalid response");
+            return;
+        }
+        // Bytes past the end of the response were never asked for.
+        if (used < static_cast<size_t>(n))
+            t->overrun = true;
+    }
+
+    if (parser->Done())
+        Complete(t, "");
+    else if (scheduler_ != nullptr && !scheduler_->MayRead(t->key, Clock::now()))
+        Pause(t);
+}
+
+// Stops reading t's response until Unpause finds its budget has
+// recovered. On the ring that means cancelling the multishot recv; data it
+// has already taken still arrives.
+void Fetcher::Pause(Transfer* t) {
+    if (t->paused)
+        return;
+    t->paused = true;
+    paused_.push_back(t->id);
+    if (!ring_.Ready())
+        Watch(t, EPOLL_CTL_MOD, 0);
+    else if (t->inflight != 0)
+        ring_.Cancel(t->inflight);
+}
+
+void Fetcher::Unpause() {
+    if (paused_.empty())
+        return;
+    auto now = Clock::now();
+    std::vector<uint64_t> still;
+    for (uint64_t id : paused_) {
+        auto it = active_.find(id);
+        if (it == active_.end())
+            continue;
+        Transfer* t = it->second.get();
+        // On the ring, the cancelled recv has to be over before a new one
+        // starts.
+        if (t->inflight != 0 || !scheduler_->MayRead(t->key, now)) {
+            still.push_back(id);
+            continue;
+        }
+        t->paused = false;
+        t->deadline = now + timeout_;
+        Watch(t, EPOLL_CTL_MOD, EPOLLIN);
+    }
+    paused_.swap(still);
+}
+
+// The server closed a pooled connection before answering; go again on a
+// fresh one.
+void Fetcher::Retry(Transfer* t) {
+    Unwatch(t);
+    pool_.Release(&t->conn, false);
+    --per_host_[t->key];
+    t->out.Rewind();
+    t->parser.reset();
+    t->res = Response();
+    Start(t);
+}
+
+void Fetcher::Complete(Transfer* t, const std::string& error) {
+    FetchResult result;
+    result.url = Url(t->request.Uri());
+    result.status = t->res.StatusCode();
+    result.bytes = t->res.RecvBytes();
+    result.error = error;
+    if (error.empty()) {
+        auto now = Clock::now();
+        t->timing.phase[kFirstByte] = t->first_byte - t->mark;
+        t->timing.phase[kTransfer] = now - t->first_byte;
+        t->timing.phase[kTotal] = now - t->started;
+        histograms_.Record(t->timing);
+        if (scheduler_ != nullptr)
+            scheduler_->Finished(t->timing.phase[kFirstByte]);
+    }
+    result.timing = t->timing;
+    // A sink that never saw a body has nothing to finish.
+    if (t->parser && t->parser->BodyBegun() && !t->sink->Finish() && result.error.empty())
+        result.error = t->sink->Error().empty() ? "failed writing body" : t->sink->Error();
+
+    Abandon(t);
+    if (t->conn.fd != -1)
+        Unwatch(t);
+    bool reusable = error.empty() && !t->overrun && t->parser && t->parser->Reusable();
+    ++t->conn.requests;
+    if (!t->conn.key.empty())
+        pool_.Release(&t->conn, reusable);
+    --per_host_[t->key];
+
+    Callback done = t->done;
+    active_.erase(t->id);
+    done(result);
+}
+
+void Fetcher::Expire() {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<Transfer*> expired;
+    for (auto& entry : active_) {
+        if (entry.second->deadline < now && !entry.second->paused)
+            expired.push_back(entry.second.get());
+    }
+    for (Transfer* t : expired) {
+        // A connect's deadline is when the next address gets its turn, or
+        // when an attempt runs out of time.
+        if (t->phase == kConnecting) {
+            if (!Dial(t))
+                Complete(t, "timed out connecting");
+            continue;
+        }
+        Complete(t, "timed out");
+    }
+}
+
+}  // namespace http
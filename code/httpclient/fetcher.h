@@ -0,0 +1,178 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_FETCHER_H_
+#define CODE_HTTPCLIENT_FETCHER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer.h"
+#include "dialer.h"
+#include "message.h"
+#include "parser.h"
+#include "pool.h"
+#include "resolver.h"
+#include "scheduler.h"
+#include "sink.h"
+#include "timing.h"
+#include "uring.h"
+#include "writer.h"
+
+namespace http {
+
+// What happened to one request run by the Fetcher. error is empty when an
+// HTTP response was received in full, whatever its status.
+struct FetchResult {
+  std::string url;
+  int status = -1;
+  int64_t bytes = 0;
+  std::string error;
+  RequestTiming timing;
+
+  bool OK() const { return error.empty(); }
+};
+
+// Runs many requests at once from a single thread. Sockets are
+// non-blocking and driven by epoll; at most max_total requests are in
+// flight, and at most max_per_host of those go to any one host:port.
+// Finished connections are kept in a ConnectionPool for the next request
+// to the same host. New connections race a host's addresses the way the
+// Dialer does, with its stagger and attempt timeout.
+//
+// With SetUring the sockets are driven through io_uring instead: sends and
+// receives are queued on the ring and handed to the kernel in one
+// io_uring_enter per loop, and each connection has a single multishot recv
+// reading into buffers registered up front. Bodies are copied out of those
+// buffers rather than spliced.
+//
+// With SetScheduler, the Scheduler decides when requests start, how many
+// run at once and how fast bodies are read; a connection it holds back is
+// paused (no longer watched for input) until its budget recovers.
+class Fetcher {
+ public:
+  typedef std::function<void(const FetchResult&)> Callback;
+
+  Fetcher(size_t max_total, size_t max_per_host, std::chrono::seconds timeout = std::chrono::seconds(30))
+      : pool_{max_per_host, std::chrono::seconds(30)}, max_total_{max_total}, max_per_host_{max_per_host},
+        timeout_{timeout}, buf_{BufferPool::Default().Get(kRecvSize)} {}
+  Fetcher(const Fetcher&) = delete;
+  Fetcher& operator=(const Fetcher&) = delete;
+  ~Fetcher();
+
+  uint64_t Add(const Request&, BodySink*, Callback);
+  bool Run();
+  // One turn of Run's loop, waiting at most timeout for the network.
+  bool Poll(std::chrono::milliseconds timeout);
+  bool Pending() const { return !active_.empty() || !waiting_.empty(); }
+  // Ends the request Add returned id for, with error as the result.
+  // Returns false if it has already finished.
+  bool Cancel(uint64_t id, const std::string& error);
+  void SetResolver(Resolver* resolver) { resolver_ = resolver; }
+  void SetDialer(const Dialer& dialer) { dialer_ = dialer; }
+  // The scheduler must outlive the Fetcher's use of it.
+  void SetScheduler(Scheduler* scheduler) { scheduler_ = scheduler; }
+  const PhaseHistograms& Histograms() const { return histograms_; }
+  // Use io_uring where the kernel has it, epoll otherwise.
+  void SetUring(bool uring) { want_uring_ = uring; }
+  bool UsingUring() const { return ring_.Ready(); }
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  static constexpr size_t kRecvSize = 256 * 1024;
+  static constexpr size_t kSpliceMin = 64 * 1024;
+  static constexpr unsigned kRingEntries = 256;
+  static constexpr unsigned kRingBuffers = 256;
+  static constexpr size_t kRingBufferSize = 16 * 1024;
+
+  enum Phase { kConnecting, kSending, kReceiving };
+  // What a ring completion is for; the low bits of its user data.
+  enum Op { kPollOp, kSendOp, kRecvOp };
+
+  // One connect in a race between a host's addresses.
+  struct Attempt {
+    int fd;
+    Clock::time_point deadline;
+  };
+
+  struct Transfer {
+    Transfer(const Request& r, BodySink* s, Callback c) : request{r}, sink{s}, done{c} {}
+
+    uint64_t id = 0;
+    Request request;
+    BodySink* sink;
+    Callback done;
+    std::string key;
+    Connection conn;
+    bool reused = false;
+    bool overrun = false;
+    bool paused = false;     // held back by the scheduler
+    Phase phase = kConnecting;
+    RequestWriter out;
+    struct msghdr msg;       // the SENDMSG on the ring
+    uint64_t inflight = 0;   // user data of the ring operation in progress
+    uint8_t generation = 0;  // bumped to disown completions still to come
+    Response res;
+    std::unique_ptr<ResponseParser> parser;
+    std::vector<Address> addrs;
+    size_t next_addr = 0;
+    std::vector<Attempt> attempts;  // connects still racing
+    Clock::time_point next_dial;    // when the next address gets its turn
+    std::chrono::steady_clock::time_point deadline;
+    RequestTiming timing;
+    Clock::time_point started;     // first Start, for the total
+    Clock::time_point mark;        // start of the connect, then of the send
+    Clock::time_point first_byte;
+  };
+
+  bool Setup();
+  size_t Limit();
+  void Launch();
+  void Start(Transfer*);
+  bool Dial(Transfer*);
+  void Abandon(Transfer*);
+  void Watch(Transfer*, int, uint32_t);
+  void WatchConnect(Transfer*, int);
+  void Unwatch(Transfer*);
+  void OnEvent(Transfer*);
+  void Send(Transfer*);
+  void OnSent(Transfer*, bool);
+  void Receive(Transfer*);
+  void Received(Transfer*, ssize_t, const char*);
+  void Pause(Transfer*);
+  void Unpause();
+  bool PollRing(std::chrono::milliseconds);
+  uint64_t Submitted(Transfer*, Op);
+  void OnCompletion(const struct io_uring_cqe&);
+  void Retry(Transfer*);
+  void Complete(Transfer*, const std::string&);
+  void Expire();
+
+  ConnectionPool pool_;
+  PhaseHistograms histograms_;
+  Resolver* resolver_ = &Resolver::Default();
+  Dialer dialer_;
+  Scheduler* scheduler_ = nullptr;
+  size_t max_total_;
+  size_t max_per_host_;
+  std::chrono::seconds timeout_;
+  int epfd_ = -1;
+  bool want_uring_ = false;
+  Uring ring_;
+  uint64_t next_id_ = 1;
+  Buffer buf_;  // for the epoll backend's reads
+  std::map<std::string, std::deque<std::unique_ptr<Transfer>>> waiting_;
+  std::map<std::string, size_t> per_host_;
+  std::string last_host_;        // the last host Launch started a request for
+  std::vector<uint64_t> paused_;
+  std::map<uint64_t, std::unique_ptr<Transfer>> active_;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_FETCHER_H_
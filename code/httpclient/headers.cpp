@@ -0,0 +1,305 @@
+// Copyright hopkiw 2026
+#include "headers.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http {
+
+namespace {
+
+const char* FindNewlineScalar(const char* p, const char* end) {
+    const void* nl = memchr(p, '\n', end - p);
+    return nl == NULL ? end : static_cast<const char*>(nl);
+}
+
+#if defined(__x86_64__)
+// SSE2 is part of x86-64, so this one needs no runtime check.
+const char* FindNewlineSSE2(const char* p, const char* end) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl));
+        if (mask != 0)
+            return p + __builtin_ctz(mask);
+    }
+    return FindNewlineScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+const char* FindNewlineAVX2(const char* p, const char* end) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    for (; end - p >= 32; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, nl));
+        if (mask != 0)
+            return p + __builtin_ctz(mask);
+    }
+    return FindNewlineSSE2(p, end);
+}
+#endif
+
+typedef const char* (*FindNewlineFn)(const char*, const char*);
+
+FindNewlineFn PickFindNewline() {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return FindNewlineAVX2;
+    return FindNewlineSSE2;
+#else
+    return FindNewlineScalar;
+#endif
+}
+
+const FindNewlineFn find_newline = PickFindNewline();
+
+bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+std::string_view TrimSpace(const char* start, const char* end) {
+    while (start < end && (*start == ' ' || *start == '\t'))
+        ++start;
+    while (end > start && (end[-1] == ' ' || end[-1] == '\t'))
+        --end;
+    return std::string_view(start, end - start);
+}
+
+}  // namespace
+
+// Returns the first '\n' in [p, end), or end if there is none.
+const char* FindNewline(const char* p, const char* end) {
+    return find_newline(p, end);
+}
+
+// Looks for the blank line that ends a response head. scan is where the
+// previous call got to, so a head that arrives in pieces is only scanned
+// once. Returns the length of the head including the blank line, or 0 if
+// it isn't complete yet.
+size_t FindHeadEnd(std::string_view buf, size_t* scan) {
+    const char* begin = buf.data();
+    const char* end = begin + buf.size();
+    const char* line = begin + *scan;
+    while (line < end) {
+        const char* nl = find_newline(line, end);
+        if (nl == end)
+            break;
+        if (nl == line || (nl == line + 1 && *line == '\r'))
+            return nl + 1 - begin;
+        line = nl + 1;
+    }
+    *scan = line - begin;
+    return 0;
+}
+
+// Parses the status line and headers at the start of buf into head, which
+// ends up pointing into buf. Returns the number of bytes in the head
+// (including the blank line), 0 if buf doesn't hold a complete head yet, -1
+// if it is malformed, or ResponseHead::kTooManyFields.
+int ParseHead(std::string_view buf, ResponseHead* head) {
+    const char* begin = buf.data();
+    const char* end = begin + buf.size();
+
+    const char* nl = find_newline(begin, end);
+    if (nl == end)
+        return 0;
+    const char* eol = (nl > begin && nl[-1] == '\r') ? nl - 1 : nl;
+
+    // HTTP/1.x SP 3DIGIT [SP reason]
+    std::string_view status(begin, eol - begin);
+    if (status.length() < 12 || status.compare(0, 7, "HTTP/1.") != 0 || !IsDigit(status[7]) || status[8] != ' '
+            || !IsDigit(status[9]) || !IsDigit(status[10]) || !IsDigit(status[11])
+            || (status.length() > 12 && status[12] != ' '))
+        return -1;
+    head->minor_version = status[7] - '0';
+    head->status = (status[9] - '0') * 100 + (status[10] - '0') * 10 + (status[11] - '0');
+    head->reason = status.length() > 13 ? status.substr(13) : std::string_view();
+    head->nfields = 0;
+
+    for (const char* line = nl + 1; ; line = nl + 1) {
+        nl = find_newline(line, end);
+        if (nl == end)
+            return 0;
+        eol = (nl > line && nl[-1] == '\r') ? nl - 1 : nl;
+        if (eol == line)
+            return nl + 1 - begin;
+
+        const char* colon = static_cast<const char*>(memchr(line, ':', eol - line));
+        // No whitespace is allowed between the field name and the colon,
+        // and obsolete line folding isn't supported.
+        if (colon == NULL || colon == line || colon[-1] == ' ' || colon[-1] == '\t' || *line == ' ' || *line == '\t')
+            return -1;
+        if (head->nfields == ResponseHead::kMaxFields)
+            return ResponseHead::kTooManyFields;
+        HeaderField& field = head->fields[head->nfields++];
+        field.name = std::string_view(line, colon - line);
+        field.value = TrimSpace(colon + 1, eol);
+    }
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.length() != b.length())
+        return false;
+    for (size_t i = 0; i < a.length(); ++i) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z')
+            x += 'a' - 'A';
+        if (y >= 'A' && y <= 'Z')
+            y += 'a' - 'A';
+        if (x != y)
+            return false;
+    }
+    return true;
+}
+
+// Whether a comma separated header value such as "keep-alive, Upgrade"
+// contains token.
+bool HasToken(std::string_view list, std::string_view token) {
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view item = list.substr(0, comma);
+        item = TrimSpace(item.data(), item.data() + item.length());
+        if (EqualsIgnoreCase(item, token))
+            return true;
+        if (comma == std::string_view::npos)
+            break;
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+// Takes over a parsed head: text is copied once and fields, which point into
+// it, become offsets.
+void HeaderMap::Assign(std::string_view text, const HeaderField* fields, size_t n) {
+    Clear();
+    wire_ = false;
+    text_.assign(text);
+    entries_.reserve(n);
+    Rehash(n);
+    for (size_t i = 0; i < n; ++i) {
+        Entry e;
+        e.name = fields[i].name.data() - text.data();
+        e.name_len = fields[i].name.length();
+        e.value = fields[i].value.data() - text.data();
+        e.value_len = fields[i].value.length();
+        e.hash = HashName(fields[i].name);
+        e.next = -1;
+        entries_.push_back(e);
+        Index(entries_.size() - 1);
+    }
+}
+
+void HeaderMap::Add(std::string_view name, std::string_view value) {
+    Entry e;
+    e.name = text_.length();
+    e.name_len = name.length();
+    text_.append(name);
+    text_.append(": ");
+    e.value = text_.length();
+    e.value_len = value.length();
+    text_.append(value);
+    text_.append("\r\n");
+    e.hash = HashName(name);
+    e.next = -1;
+    entries_.push_back(e);
+    Index(entries_.size() - 1);
+}
+
+void HeaderMap::Clear() {
+    text_.clear();
+    entries_.clear();
+    slots_.assign(slots_.size(), -1);
+    names_ = 0;
+    wire_ = true;
+}
+
+bool HeaderMap::Wire(std::string_view* text) const {
+    if (!wire_)
+        return false;
+    *text = text_;
+    return true;
+}
+
+HeaderField HeaderMap::At(size_t i) const {
+    return HeaderField{Name(entries_[i]), Value(entries_[i])};
+}
+
+std::string_view HeaderMap::Get(const HeaderName& name) const {
+    int32_t i = Find(name);
+    return i == -1 ? std::string_view() : Value(entries_[i]);
+}
+
+std::vector<std::string_view> HeaderMap::GetAll(const HeaderName& name) const {
+    std::vector<std::string_view> values;
+    for (int32_t i = Find(name); i != -1; i = entries_[i].next)
+        values.push_back(Value(entries_[i]));
+    return values;
+}
+
+int32_t HeaderMap::Find(const HeaderName& name) const {
+    return Find(name.name, name.hash);
+}
+
+int32_t HeaderMap::Find(std::string_view name, uint32_t hash) const {
+    if (slots_.empty())
+        return -1;
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask; slots_[slot] != -1; slot = (slot + 1) & mask) {
+        const Entry& e = entries_[slots_[slot]];
+        if (e.hash == hash && EqualsIgnoreCase(Name(e), name))
+            return slots_[slot];
+    }
+    return -1;
+}
+
+// Links entry i into the index: onto the end of its name's chain if the
+// name is already there, otherwise into a free slot.
+void HeaderMap::Index(int32_t i) {
+    Entry& e = entries_[i];
+    int32_t first = Find(Name(e), e.hash);
+    if (first != -1) {
+        while (entries_[first].next != -1)
+            first = entries_[first].next;
+        entries_[first].next = i;
+        return;
+    }
+
+    if ((names_ + 1) * 2 > slots_.size())
+        Rehash(names_ + 1);
+    size_t mask = slots_.size() - 1;
+    size_t slot = e.hash & mask;
+    while (slots_[slot] != -1)
+        slot = (slot + 1) & mask;
+    slots_[slot] = i;
+    ++names_;
+}
+
+// Grows the table to hold at least n names at no more than half full.
+void HeaderMap::Rehash(size_t n) {
+    size_t size = 16;
+    while (size < n * 2)
+        size *= 2;
+    if (size <= slots_.size())
+        return;
+
+    std::vector<int32_t> old;
+    old.swap(slots_);
+    slots_.assign(size, -1);
+    for (int32_t first : old) {
+        if (first == -1)
+            continue;
+        size_t slot = entries_[first].hash & (size - 1);
+        while (slots_[slot] != -1)
+            slot = (slot + 1) & (size - 1);
+        slots_[slot] = first;
+    }
+}
+
+}  // namespace http
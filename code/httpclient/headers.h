@@ -0,0 +1,142 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_HEADERS_H_
+#define CODE_HTTPCLIENT_HEADERS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http {
+
+// One header line, as views into the buffer it was parsed from.
+struct HeaderField {
+  std::string_view name;
+  std::string_view value;
+};
+
+// The status line and header lines of a response. Everything points into
+// the buffer handed to ParseHead; nothing is copied or allocated. Room for
+// kMaxFields lines is well past what real servers send, cookies and all;
+// the parser's kMaxHead bounds the head's size anyway.
+struct ResponseHead {
+  static constexpr size_t kMaxFields = 256;
+  // What ParseHead returns for a head with more lines than that.
+  static constexpr int kTooManyFields = -2;
+
+  int minor_version = -1;
+  int status = -1;
+  std::string_view reason;
+  HeaderField fields[kMaxFields];
+  size_t nfields = 0;
+};
+
+// FNV-1a over the lowercased name, so names that differ only in case hash
+// the same.
+constexpr uint32_t HashName(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+// A header name together with its hash. The well-known names below are
+// hashed at compile time, so looking them up costs one probe and one
+// compare.
+struct HeaderName {
+  constexpr HeaderName(std::string_view n) : name{n}, hash{HashName(n)} {}
+  constexpr HeaderName(const char* n) : HeaderName(std::string_view(n)) {}
+  HeaderName(const std::string& n) : HeaderName(std::string_view(n)) {}
+
+  std::string_view name;
+  uint32_t hash;
+};
+
+inline constexpr HeaderName kAcceptEncoding{"Accept-Encoding"};
+inline constexpr HeaderName kAcceptRanges{"Accept-Ranges"};
+inline constexpr HeaderName kCacheControl{"Cache-Control"};
+inline constexpr HeaderName kConnection{"Connection"};
+inline constexpr HeaderName kContentEncoding{"Content-Encoding"};
+inline constexpr HeaderName kContentLength{"Content-Length"};
+inline constexpr HeaderName kContentRange{"Content-Range"};
+inline constexpr HeaderName kContentType{"Content-Type"};
+inline constexpr HeaderName kDate{"Date"};
+inline constexpr HeaderName kETag{"ETag"};
+inline constexpr HeaderName kExpect{"Expect"};
+inline constexpr HeaderName kExpires{"Expires"};
+inline constexpr HeaderName kLastModified{"Last-Modified"};
+inline constexpr HeaderName kLocation{"Location"};
+inline constexpr HeaderName kSetCookie{"Set-Cookie"};
+inline constexpr HeaderName kTransferEncoding{"Transfer-Encoding"};
+inline constexpr HeaderName kVary{"Vary"};
+
+// Header fields in arrival order with a case-insensitive hash index over
+// the names. Names and values live in one string owned by the map; lookups
+// hand out views into it and never copy. Repeated fields such as
+// Set-Cookie are chained so GetAll can return every value.
+class HeaderMap {
+ public:
+  class Iterator {
+   public:
+    Iterator(const HeaderMap* map, size_t i) : map_{map}, i_{i} {}
+    HeaderField operator*() const { return map_->At(i_); }
+    Iterator& operator++() { ++i_; return *this; }
+    bool operator!=(const Iterator& other) const { return i_ != other.i_; }
+
+   private:
+    const HeaderMap* map_;
+    size_t i_;
+  };
+
+  void Assign(std::string_view, const HeaderField*, size_t);
+  void Add(std::string_view, std::string_view);
+  void Clear();
+
+  size_t Size() const { return entries_.size(); }
+  bool Empty() const { return entries_.empty(); }
+  HeaderField At(size_t) const;
+  Iterator begin() const { return Iterator(this, 0); }
+  Iterator end() const { return Iterator(this, entries_.size()); }
+
+  bool Has(const HeaderName& name) const { return Find(name) != -1; }
+  std::string_view Get(const HeaderName&) const;
+  std::vector<std::string_view> GetAll(const HeaderName&) const;
+
+  // Every field as "Name: value\r\n", ready to send, if the map was built
+  // with Add alone. A map filled by Assign holds the raw head instead.
+  bool Wire(std::string_view*) const;
+
+ private:
+  struct Entry {
+    uint32_t name, name_len, value, value_len;
+    uint32_t hash;
+    int32_t next;  // next entry with the same name, or -1
+  };
+
+  std::string_view Name(const Entry& e) const { return std::string_view(text_).substr(e.name, e.name_len); }
+  std::string_view Value(const Entry& e) const { return std::string_view(text_).substr(e.value, e.value_len); }
+  int32_t Find(const HeaderName&) const;
+  int32_t Find(std::string_view, uint32_t) const;
+  void Index(int32_t);
+  void Rehash(size_t);
+
+  std::string text_;
+  std::vector<Entry> entries_;
+  std::vector<int32_t> slots_;  // open addressing, first entry per name or -1
+  size_t names_ = 0;
+  bool wire_ = true;
+};
+
+const char* FindNewline(const char*, const char*);
+size_t FindHeadEnd(std::string_view, size_t*);
+int ParseHead(std::string_view, ResponseHead*);
+bool EqualsIgnoreCase(std::string_view, std::string_view);
+bool HasToken(std::string_view, std::string_view);
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_HEADERS_H_
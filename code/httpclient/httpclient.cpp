@@ -0,0 +1,372 @@
+// Copyright hopkiw 2026
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "client.h"
+#include "digest.h"
+#include "fetcher.h"
+#include "resolver.h"
+#include "scheduler.h"
+#include "sink.h"
+#include "uri.h"
+
+// Reads the URLs listed in file, one per line, "-" for stdin. A URL may be
+// followed by the digests its body should have, as sha256=<hex> and
+// crc32c=<hex>, which go in digests. Blank lines and lines starting with #
+// are skipped; invalid lines are reported and counted in invalid.
+static bool ReadList(const std::string& file, std::vector<http::URI>* uris, std::vector<http::Digests>* digests,
+                     size_t* invalid) {
+    std::ifstream input;
+    if (file != "-") {
+        input.open(file);
+        if (!input.is_open()) {
+            std::cerr << "Failed to open " << file << std::endl;
+            return false;
+        }
+    }
+    std::istream& in = file == "-" ? std::cin : input;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        std::string url, field;
+        fields >> url;
+        http::URI uri = http::URI::Parse(url);
+        if (uri.Host == "") {
+            std::cout << "invalid URI: " << line << std::endl;
+            ++*invalid;
+            continue;
+        }
+        http::Digests expected;
+        bool valid = true;
+        while (fields >> field)
+            valid = valid && expected.Parse(field);
+        if (!valid) {
+            std::cout << "invalid digest: " << line << std::endl;
+            ++*invalid;
+            continue;
+        }
+        uris->push_back(uri);
+        digests->push_back(expected);
+    }
+    return true;
+}
+
+static void PrintResult(int status, int64_t bytes, const std::string& url, const std::string& error) {
+    std::cout << std::setw(3) << status << " " << std::setw(12) << bytes << " " << url;
+    if (!error.empty())
+        std::cout << " (" << error << ")";
+    std::cout << std::endl;
+}
+
+static void PrintSummary(size_t done, size_t failed, int64_t bytes, double seconds) {
+    std::cout << done << " fetched, " << failed << " failed, " << bytes << " bytes in "
+              << std::fixed << std::setprecision(3) << seconds << "s ("
+              << std::setprecision(1) << (seconds > 0 ? bytes / seconds / (1024 * 1024) : 0) << " MB/s)"
+              << std::endl;
+    const http::Resolver& resolver = http::Resolver::Default();
+    std::cout << "dns: " << resolver.Hits() << " hits (" << resolver.NegativeHits() << " negative), "
+              << resolver.Misses() << " misses" << std::endl;
+}
+
+// Fetches every URL listed in file and prints a line per URL as it
+// finishes. A budget with any rate set is kept to by a Scheduler. Bodies
+// with digests listed are checked as they are written.
+static int FetchAll(const std::string& file, size_t max_total, size_t max_per_host, const http::Budget& budget,
+                    bool uring, bool timing) {
+    std::vector<http::URI> uris;
+    std::vector<http::Digests> digests;
+    size_t failed = 0, done = 0;
+    if (!ReadList(file, &uris, &digests, &failed))
+        return 1;
+
+    http::Throughput stats;
+    http::Fetcher fetcher(max_total, max_per_host);
+    fetcher.SetUring(uring);
+    std::unique_ptr<http::Scheduler> scheduler;
+    if (budget.bytes_per_sec > 0 || budget.requests_per_sec > 0 || budget.host_bytes_per_sec > 0 ||
+        budget.host_requests_per_sec > 0) {
+        scheduler.reset(new http::Scheduler(budget));
+        fetcher.SetScheduler(scheduler.get());
+    }
+    std::vector<std::unique_ptr<http::FileSink>> sinks;
+    std::vector<std::unique_ptr<http::DigestSink>> checks;
+    for (size_t i = 0; i < uris.size(); ++i) {
+        const http::URI& uri = uris[i];
+        sinks.emplace_back(new http::FileSink("./" + http::LocalPath(uri), &stats));
+        http::BodySink* sink = sinks.back().get();
+        if (!digests[i].Empty()) {
+            checks.emplace_back(new http::DigestSink(sink, digests[i], "./" + http::LocalPath(uri)));
+            sink = checks.back().get();
+        }
+        fetcher.Add(http::Request(uri), sink, [&](const http::FetchResult& result) {
+            ++done;
+            if (!result.OK() || result.status < 200 || result.status >= 300)
+                ++failed;
+            PrintResult(result.status, result.bytes, result.url, result.error);
+            if (timing && result.OK())
+                std::cout << "    " << result.timing.ToString() << std::endl;
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (!fetcher.Run())
+        return 1;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    PrintSummary(done, failed, stats.Bytes(), seconds);
+    if (scheduler)
+        std::cout << scheduler->ToString() << std::endl;
+    if (timing)
+        std::cout << fetcher.Histograms().ToString();
+    return failed == 0 ? 0 : 1;
+}
+
+// Like FetchAll, but pipelines the requests to each host over a single
+// connection with Client::DoMany.
+static int PipelineAll(const std::string& file, bool compress, bool timing) {
+    std::vector<http::URI> uris;
+    std::vector<http::Digests> digests;
+    size_t failed = 0, done = 0;
+    if (!ReadList(file, &uris, &digests, &failed))
+        return 1;
+    if (std::any_of(digests.begin(), digests.end(), [](const http::Digests& d) { return !d.Empty(); }))
+        std::cout << "digests aren't checked when pipelining" << std::endl;
+
+    std::vector<http::Request> requests;
+    for (const http::URI& uri : uris)
+        requests.push_back(http::Request(uri));
+
+    http::Client client;
+    client.SetCompression(compress);
+    auto start = std::chrono::steady_clock::now();
+    client.DoMany(requests, [&](size_t i, const http::Response& res) {
+        ++done;
+        if (!res.OK())
+            ++failed;
+        const http::URI& uri = uris[i];
+        PrintResult(res.StatusCode(), res.RecvBytes(), uri.Host + (uri.Port.empty() ? "" : ":" + uri.Port) + uri.Path,
+                    res.StatusCode() == -1 ? "no response" : "");
+        if (timing && res.StatusCode() != -1)
+            std::cout << "    " << client.LastTiming().ToString() << std::endl;
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    PrintSummary(done, failed, client.Stats().Bytes(), seconds);
+    if (timing)
+        std::cout << client.Histograms().ToString();
+    return failed == 0 ? 0 : 1;
+}
+
+static void Usage(const char* prog) {
+    std::cerr << "To get started, type " << prog << " <URL>" << std::endl;
+    std::cerr << "  or " << prog << " -s <segments> <URL> to download one file over several connections" << std::endl;
+    std::cerr << "  or " << prog << " [-c max_total] [-C max_per_host] -i <file of URLs, - for stdin>" << std::endl;
+    std::cerr << "  or " << prog << " -p -i <file of URLs> to pipeline the requests to each host" << std::endl;
+    std::cerr << "  -b <KiB/s> and -q <requests/s> cap a list's bandwidth and request rate; -B and -Q do"
+              << " the same per host" << std::endl;
+    std::cerr << "  -U drives a list's connections with io_uring, where the kernel has it" << std::endl;
+    std::cerr << "  -z asks for gzip or deflate bodies and decodes them (single URL and -p)" << std::endl;
+    std::cerr << "  -t prints where each request spent its time, and percentiles for a list" << std::endl;
+    std::cerr << "  -L <hops> follows at most that many redirects (default 10, 0 for none)" << std::endl;
+    std::cerr << "  -X <method> sets the method; -T <file> uploads file as the body (PUT by default), - for"
+              << " stdin" << std::endl;
+    std::cerr << "  -V sha256=<hex> or crc32c=<hex> checks a single URL's body as it is written; in a list,"
+              << " put them after the URL" << std::endl;
+    std::cerr << "  -r resumes an interrupted download of the same URL" << std::endl;
+    std::cerr << "  -d <dir> caches responses in dir, -M <MiB> caps its size (default 256)" << std::endl;
+    std::cerr << "  -H <hosts file> resolves names from an /etc/hosts style file instead of DNS" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string list;
+    size_t max_total = 64;
+    size_t max_per_host = 6;
+    int segments = 0;
+    bool pipeline = false;
+    bool compress = false;
+    bool resume = false;
+    bool timing = false;
+    bool uring = false;
+    std::string cache_dir;
+    int64_t cache_mb = 256;
+    http::Budget budget;
+    int redirects = -1;
+    std::string method;
+    std::string upload;
+    http::Digests expected;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "i:c:C:s:H:pzd:M:rtUb:q:B:Q:L:X:T:V:")) != -1) {
+        switch (opt) {
+        case 'H':
+            if (!http::Resolver::Default().LoadHostsFile(optarg))
+                return 1;
+            break;
+        case 's':
+            segments = atoi(optarg);
+            break;
+        case 'i':
+            list = optarg;
+            break;
+        case 'p':
+            pipeline = true;
+            break;
+        case 'z':
+            compress = true;
+            break;
+        case 'r':
+            resume = true;
+            break;
+        case 't':
+            timing = true;
+            break;
+        case 'U':
+            uring = true;
+            break;
+        case 'd':
+            cache_dir = optarg;
+            break;
+        case 'M':
+            cache_mb = std::max(1, atoi(optarg));
+            break;
+        case 'b':
+            budget.bytes_per_sec = std::max(0.0, atof(optarg)) * 1024;
+            break;
+        case 'q':
+            budget.requests_per_sec = std::max(0.0, atof(optarg));
+            break;
+        case 'B':
+            budget.host_bytes_per_sec = std::max(0.0, atof(optarg)) * 1024;
+            break;
+        case 'Q':
+            budget.host_requests_per_sec = std::max(0.0, atof(optarg));
+            break;
+        case 'L':
+            redirects = std::max(0, atoi(optarg));
+            break;
+        case 'X':
+            method = optarg;
+            break;
+        case 'T':
+            upload = optarg;
+            break;
+        case 'V':
+            if (!expected.Parse(optarg)) {
+                std::cerr << "invalid digest: " << optarg << std::endl;
+                return 1;
+            }
+            break;
+        case 'c':
+            max_total = std::max(1, atoi(optarg));
+            break;
+        case 'C':
+            max_per_host = std::max(1, atoi(optarg));
+            break;
+        default:
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!list.empty())
+        return pipeline ? PipelineAll(list, compress, timing)
+                        : FetchAll(list, max_total, max_per_host, budget, uring, timing);
+
+    if (optind != argc - 1) {
+        std::cerr << "Invalid input; too few arguments" << std::endl;
+        Usage(argv[0]);
+        return 1;
+    }
+
+    http::URI uri = http::URI::Parse(argv[optind]);
+    if (uri.Host == "") {
+        std::cout << "invalid URI" << std::endl;
+        return 1;
+    }
+
+    if (method.empty())
+        method = upload.empty() ? "GET" : "PUT";
+    http::Request request(uri, method);
+    if (upload == "-") {
+        // stdin's length isn't known up front, so it goes chunked.
+        request.SetBodyProducer([](std::string* chunk) {
+            chunk->resize(64 * 1024);
+            std::cin.read(&(*chunk)[0], chunk->size());
+            chunk->resize(std::cin.gcount());
+            return !std::cin.bad();
+        });
+    } else if (!upload.empty() && !request.SetBodyFile(upload)) {
+        std::cout << "can't read " << upload << std::endl;
+        return 1;
+    }
+
+    http::Client client;
+    client.SetCompression(compress);
+    client.SetResume(resume);
+    if (redirects >= 0)
+        client.SetMaxRedirects(redirects);
+    std::unique_ptr<http::DiskCache> cache;
+    if (!cache_dir.empty()) {
+        cache.reset(new http::DiskCache(cache_dir, cache_mb * 1024 * 1024));
+        if (!cache->Open())
+            return 1;
+        client.SetCache(cache.get());
+    }
+    // Checking a digest takes the body through a sink, which leaves out
+    // the cache, resuming and segments.
+    http::Response response;
+    if (!expected.Empty()) {
+        http::Throughput written;
+        http::FileSink file("./" + http::LocalPath(uri), &written);
+        http::DigestSink check(&file, expected, "./" + http::LocalPath(uri));
+        response = client.Do(request, &check);
+        if (!check.Verified()) {
+            std::cout << "not verified" << (check.Error().empty() ? "" : ": " + check.Error()) << std::endl;
+            return 1;
+        }
+        std::cout << "verified " << http::LocalPath(uri) << std::endl;
+    } else {
+        response = segments > 1 ? client.DownloadSegmented(request, segments) : client.Do(request);
+    }
+
+    if (!response.OK())
+        std::cout << "Error response from server: " << response.StatusCode() << std::endl;
+    std::cout << "transferred " << client.Stats().ToString() << std::endl;
+    if (timing)
+        std::cout << "timing: " << client.LastTiming().ToString() << std::endl;
+    if (cache)
+        std::cout << "cache: " << cache->Entries() << " entries, " << cache->Bytes() << " bytes, "
+                  << cache->Hits() << " hits, " << cache->Revalidated() << " revalidated, " << cache->Misses()
+                  << " misses" << std::endl;
+
+    const http::HeaderMap& headers = response.Headers();
+    std::cout << "got " << headers.Size() << " headers:" << std::endl;
+    size_t longest = 0;
+    for (const auto& hdr : headers) {
+        if (hdr.name.length() > longest)
+            longest = hdr.name.length();
+    }
+    for (const auto& hdr : headers) {
+        std::cout << "Key: ";
+
+        std::cout << std::left << std::setw(longest + 3) << ("\"" + std::string(hdr.name) + "\"");
+        std::cout << "Value: " << "\"" << hdr.value << "\"" << std::endl;
+    }
+
+    // -1 means the transfer itself failed, e.g. the body was cut short.
+    return response.StatusCode() == -1 ? 1 : 0;
+}
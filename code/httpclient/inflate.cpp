@@ -0,0 +1,113 @@
+// Copyright hopkiw 2026
+#include "inflate.h"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+#include "headers.h"
+
+namespace http {
+
+InflateSink::~InflateSink() {
+    if (decoding_)
+        inflateEnd(&zs_);
+}
+
+bool InflateSink::Begin(int64_t length) {
+    std::string_view encoding = res_->Headers().Get(kContentEncoding);
+    bool gzip = EqualsIgnoreCase(encoding, "gzip") || EqualsIgnoreCase(encoding, "x-gzip");
+    if (!gzip && !EqualsIgnoreCase(encoding, "deflate"))
+        return next_->Begin(length);
+
+    // Window bits 15 + 16 takes gzip only; 15 + 32 takes either zlib or
+    // gzip framing, which covers "deflate" as most servers send it.
+    memset(&zs_, 0, sizeof(zs_));
+    if (inflateInit2(&zs_, gzip ? 15 + 16 : 15 + 32) != Z_OK) {
+        std::cout << "Failed to set up inflate" << std::endl;
+        return false;
+    }
+    decoding_ = true;
+    window_.resize(kWindowSize);
+    // The decoded length isn't known until the end.
+    return next_->Begin(-1);
+}
+
+bool InflateSink::Write(const char* data, size_t len) {
+    if (!decoding_)
+        return next_->Write(data, len);
+    in_ += len;
+    return Inflate(data, len);
+}
+
+bool InflateSink::Inflate(const char* data, size_t len) {
+    zs_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zs_.avail_in = len;
+
+    while (true) {
+        if (ended_) {
+            // gzip allows several members back to back; anything else
+            // after the end of the stream is junk and dropped.
+            if (zs_.avail_in == 0 || raw_ || zs_.next_in[0] != 0x1f)
+                return true;
+            inflateReset(&zs_);
+            ended_ = false;
+        }
+
+        zs_.next_out = reinterpret_cast<Bytef*>(window_.data());
+        zs_.avail_out = window_.size();
+        int rc = inflate(&zs_, Z_NO_FLUSH);
+
+        // Some servers send "deflate" as a bare deflate stream with no
+        // zlib header. Start over in raw mode if the very first bytes
+        // don't parse.
+        if (rc == Z_DATA_ERROR && !started_ && !raw_) {
+            inflateEnd(&zs_);
+            memset(&zs_, 0, sizeof(zs_));
+            if (inflateInit2(&zs_, -15) != Z_OK)
+                return false;
+            raw_ = true;
+            return Inflate(data, len);
+        }
+        if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
+            std::cout << "Failed to inflate body: " << (zs_.msg ? zs_.msg : "unknown error") << std::endl;
+            return false;
+        }
+        started_ = true;
+        if (rc == Z_STREAM_END)
+            ended_ = true;
+
+        size_t produced = window_.size() - zs_.avail_out;
+        if (produced > 0) {
+            out_ += produced;
+            if (!next_->Write(window_.data(), produced))
+                return false;
+        }
+        // Done once the input is used up and zlib has nothing more to hand
+        // out, i.e. it didn't fill the window.
+        if (zs_.avail_in == 0 && zs_.avail_out != 0)
+            return true;
+        if (rc == Z_BUF_ERROR && produced == 0)
+            return true;
+    }
+}
+
+bool InflateSink::Finish() {
+    bool ok = true;
+    if (decoding_) {
+        if (started_ && !ended_) {
+            std::cout << "Compressed body ended early" << std::endl;
+            ok = false;
+        }
+        inflateEnd(&zs_);
+        decoding_ = false;
+        window_ = std::vector<char>();
+        if (stats_)
+            stats_->AddEncoded(in_, out_);
+    }
+    return next_->Finish() && ok;
+}
+
+}  // namespace http
@@ -0,0 +1,56 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_INFLATE_H_
+#define CODE_HTTPCLIENT_INFLATE_H_
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "message.h"
+#include "sink.h"
+
+namespace http {
+
+// Sits between the parser and another sink and undoes gzip or deflate
+// Content-Encoding as the body streams through. Whether to decode is
+// decided in Begin from the response's headers; bodies in any other
+// encoding pass through untouched, spliceable as before. Decoding goes
+// through a fixed-size window, so memory use doesn't grow with the body.
+class InflateSink : public BodySink {
+ public:
+  static constexpr size_t kWindowSize = 64 * 1024;
+
+  InflateSink(const Response* res, BodySink* next, Throughput* stats) : res_{res}, next_{next}, stats_{stats} {}
+  InflateSink(const InflateSink&) = delete;
+  InflateSink& operator=(const InflateSink&) = delete;
+  ~InflateSink();
+
+  void Head(const Response& res) override { next_->Head(res); }
+  bool Begin(int64_t) override;
+  bool Write(const char*, size_t) override;
+  bool Finish() override;
+  bool CanSplice() const override { return !decoding_ && next_->CanSplice(); }
+  ssize_t Splice(int sockfd, size_t len) override { return next_->Splice(sockfd, len); }
+
+  bool Decoding() const { return decoding_; }
+
+ private:
+  bool Inflate(const char*, size_t);
+
+  const Response* res_;
+  BodySink* next_;
+  Throughput* stats_;
+  z_stream zs_;
+  bool decoding_ = false;
+  bool raw_ = false;      // deflate without the zlib wrapper
+  bool started_ = false;  // some input has been accepted
+  bool ended_ = false;    // the compressed stream is complete
+  uint64_t in_ = 0;
+  uint64_t out_ = 0;
+  std::vector<char> window_;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_INFLATE_H_
@@ -0,0 +1,308 @@
+// Copyright hopkiw 2026
+#include "loopback.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace http {
+
+namespace {
+
+std::string Gzip(const std::string& data) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    // 16 + MAX_WBITS asks zlib for a gzip wrapper.
+    deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&zs, data.length()), '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    zs.avail_in = data.length();
+    zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    zs.avail_out = out.length();
+    deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+
+}  // namespace
+
+bool LoopbackServer::Start() {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ == -1) {
+        std::cout << "Failed to create socket" << std::endl;
+        return false;
+    }
+    int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1 ||
+        listen(listen_fd_, 1024) == -1 ||
+        getsockname(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), &len) == -1) {
+        std::cout << "Failed to listen: " << strerror(errno) << std::endl;
+        return false;
+    }
+    port_ = ntohs(addr.sin_port);
+
+    if ((epfd_ = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+        std::cout << "Failed to create epoll instance" << std::endl;
+        return false;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd_;
+    epoll_ctl(epfd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+
+    thread_ = std::thread(&LoopbackServer::Run, this);
+    return true;
+}
+
+void LoopbackServer::Stop() {
+    if (thread_.joinable()) {
+        stop_ = true;
+        thread_.join();
+    }
+    while (!conns_.empty())
+        Close(conns_.begin()->second.get());
+    if (listen_fd_ != -1)
+        close(listen_fd_);
+    if (epfd_ != -1)
+        close(epfd_);
+    listen_fd_ = epfd_ = -1;
+}
+
+void LoopbackServer::Run() {
+    struct epoll_event events[64];
+    while (!stop_) {
+        // Wake up in time for the next delayed response, and now and then
+        // to notice Stop.
+        auto now = Clock::now();
+        int timeout = 50;
+        for (auto& entry : conns_) {
+            Conn* conn = entry.second.get();
+            if (!conn->queue.empty() && conn->queue.front().ready > now) {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(conn->queue.front().ready - now);
+                timeout = std::min(timeout, static_cast<int>(wait.count()) + 1);
+            }
+        }
+
+        int n = epoll_wait(epfd_, events, 64, timeout);
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listen_fd_) {
+                Accept();
+                continue;
+            }
+            auto it = conns_.find(fd);
+            if (it == conns_.end())
+                continue;
+            Conn* conn = it->second.get();
+            if (events[i].events & EPOLLOUT) {
+                if (!Flush(conn))
+                    continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                OnReadable(conn);
+        }
+
+        // Responses whose delay has run out.
+        now = Clock::now();
+        std::vector<Conn*> due;
+        for (auto& entry : conns_) {
+            Conn* conn = entry.second.get();
+            if (!conn->writable_wanted && !conn->queue.empty() && conn->queue.front().ready <= now)
+                due.push_back(conn);
+        }
+        for (Conn* conn : due)
+            Flush(conn);
+    }
+}
+
+void LoopbackServer::Accept() {
+    while (true) {
+        int fd = accept4(listen_fd_, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1)
+            return;
+        std::unique_ptr<Conn> conn(new Conn);
+        conn->fd = fd;
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev);
+        conns_[fd] = std::move(conn);
+    }
+}
+
+void LoopbackServer::OnReadable(Conn* conn) {
+    char buf[16 * 1024];
+    while (true) {
+        ssize_t n = recv(conn->fd, buf, sizeof(buf), 0);
+        if (n == 0 || (n == -1 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            Close(conn);
+            return;
+        }
+        if (n == -1)
+            break;
+        conn->in.append(buf, n);
+    }
+
+    size_t end;
+    while ((end = conn->in.find("\r\n\r\n")) != std::string::npos) {
+        // "GET /<size>[-opts] HTTP/1.1"
+        size_t sp = conn->in.find(' ');
+        size_t path_end = conn->in.find(' ', sp + 1);
+        std::string path = sp < end && path_end < end ? conn->in.substr(sp + 1, path_end - sp - 1) : "";
+        bool accepts_gzip = conn->in.substr(0, end).find("\r\nAccept-Encoding: gzip") != std::string::npos;
+        conn->in.erase(0, end + 4);
+
+        char* p = NULL;
+        int64_t size = path.length() > 1 ? strtoll(path.c_str() + 1, &p, 10) : -1;
+        bool chunked = false, close_after = false, gzip = false;
+        int delay = 0;
+        for (; p != NULL && *p == '-'; ) {
+            ++p;
+            if (*p == 'c') {
+                chunked = true;
+                ++p;
+            } else if (*p == 'x') {
+                close_after = true;
+                ++p;
+            } else if (*p == 'g') {
+                gzip = accepts_gzip;
+                ++p;
+            } else if (*p == 'd') {
+                delay = strtol(p + 1, &p, 10);
+            } else {
+                size = -1;
+                break;
+            }
+        }
+
+        Pending pending;
+        pending.response = Response(size, chunked, close_after, gzip);
+        pending.ready = Clock::now() + std::chrono::milliseconds(delay);
+        pending.close = close_after || size < 0;
+        conn->queue.push_back(pending);
+        ++requests_;
+    }
+    Flush(conn);
+}
+
+// Sends whatever responses are due. Returns false if the connection was
+// closed.
+bool LoopbackServer::Flush(Conn* conn) {
+    auto now = Clock::now();
+    while (!conn->queue.empty() && conn->queue.front().ready <= now) {
+        const Pending& front = conn->queue.front();
+        const std::string& response = *front.response;
+        while (conn->sent < response.length()) {
+            ssize_t n = send(conn->fd, response.data() + conn->sent, response.length() - conn->sent, MSG_NOSIGNAL);
+            if (n == -1) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    Close(conn);
+                    return false;
+                }
+                if (!conn->writable_wanted) {
+                    struct epoll_event ev;
+                    memset(&ev, 0, sizeof(ev));
+                    ev.events = EPOLLIN | EPOLLOUT;
+                    ev.data.fd = conn->fd;
+                    epoll_ctl(epfd_, EPOLL_CTL_MOD, conn->fd, &ev);
+                    conn->writable_wanted = true;
+                }
+                return true;
+            }
+            conn->sent += n;
+        }
+        if (front.close) {
+            Close(conn);
+            return false;
+        }
+        conn->queue.pop_front();
+        conn->sent = 0;
+    }
+
+    if (conn->writable_wanted) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = conn->fd;
+        epoll_ctl(epfd_, EPOLL_CTL_MOD, conn->fd, &ev);
+        conn->writable_wanted = false;
+    }
+    return true;
+}
+
+void LoopbackServer::Close(Conn* conn) {
+    epoll_ctl(epfd_, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    conns_.erase(conn->fd);
+}
+
+// Builds, or finds already built, the whole response for a body of size
+// bytes. A size below zero gets a 404.
+std::shared_ptr<const std::string> LoopbackServer::Response(int64_t size, bool chunked, bool close_after, bool gzip) {
+    std::string key = std::to_string(size) + (chunked ? "c" : "") + (close_after ? "x" : "") + (gzip ? "g" : "");
+    auto it = responses_.find(key);
+    if (it != responses_.end())
+        return it->second;
+
+    std::string response;
+    if (size < 0) {
+        response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    } else {
+        std::string body(size, '\0');
+        for (int64_t i = 0; i < size; ++i)
+            body[i] = "0123456789abcdef"[i % 16];
+
+        response = "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n";
+        if (gzip) {
+            body = Gzip(body);
+            response += "Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n";
+            response += "ETag: \"" + std::to_string(size) + "-gzip\"\r\n";
+        } else {
+            response += "ETag: \"" + std::to_string(size) + "\"\r\n";
+        }
+        if (close_after)
+            response += "Connection: close\r\n";
+        if (!chunked) {
+            response += "Content-Length: " + std::to_string(body.length()) + "\r\n\r\n" + body;
+        } else {
+            response += "Transfer-Encoding: chunked\r\n\r\n";
+            const size_t kChunk = 16 * 1024;
+            char line[32];
+            for (size_t off = 0; off < body.length(); off += kChunk) {
+                size_t len = std::min(kChunk, body.length() - off);
+                snprintf(line, sizeof(line), "%zx\r\n", len);
+                response += line;
+                response.append(body, off, len);
+                response += "\r\n";
+            }
+            response += "0\r\n\r\n";
+        }
+    }
+
+    auto shared = std::make_shared<const std::string>(std::move(response));
+    responses_[key] = shared;
+    return shared;
+}
+
+}  // namespace http
@@ -0,0 +1,77 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_LOOPBACK_H_
+#define CODE_HTTPCLIENT_LOOPBACK_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace http {
+
+// A small HTTP/1.1 server on 127.0.0.1 for benchmarks, so the client can be
+// measured without a real server's costs or the network's noise. It runs
+// one epoll loop on its own thread and serves synthetic bodies described
+// by the path:
+//
+//   /<size>[-c][-x][-d<ms>][-g]
+//
+// size is the body length in bytes; c sends it chunked, x closes the
+// connection after the response, d<ms> holds the response back for that
+// many milliseconds, and g gzips it for requests that accept gzip, with an
+// ETag for each encoding. Connections are otherwise kept alive, and
+// pipelined requests are answered in order.
+class LoopbackServer {
+ public:
+  LoopbackServer() {}
+  LoopbackServer(const LoopbackServer&) = delete;
+  LoopbackServer& operator=(const LoopbackServer&) = delete;
+  ~LoopbackServer() { Stop(); }
+
+  // Listens on an ephemeral port and starts serving.
+  bool Start();
+  void Stop();
+  int Port() const { return port_; }
+  uint64_t Requests() const { return requests_; }
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Pending {
+    std::shared_ptr<const std::string> response;
+    Clock::time_point ready;
+    bool close;
+  };
+
+  struct Conn {
+    int fd;
+    std::string in;
+    std::deque<Pending> queue;
+    size_t sent = 0;  // of queue.front()
+    bool writable_wanted = false;
+  };
+
+  void Run();
+  void Accept();
+  void OnReadable(Conn*);
+  bool Flush(Conn*);
+  void Close(Conn*);
+  std::shared_ptr<const std::string> Response(int64_t size, bool chunked, bool close, bool gzip);
+
+  int listen_fd_ = -1;
+  int epfd_ = -1;
+  int port_ = 0;
+  std::atomic<bool> stop_{false};
+  std::atomic<uint64_t> requests_{0};
+  std::thread thread_;
+  std::map<int, std::unique_ptr<Conn>> conns_;
+  std::map<std::string, std::shared_ptr<const std::string>> responses_;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_LOOPBACK_H_
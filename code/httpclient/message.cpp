@@ -0,0 +1,213 @@
+// Copyright hopkiw 2026
+#include "message.h"
+
+#include <sys/stat.h>
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "headers.h"
+
+namespace http {
+
+namespace {
+
+void Append(std::vector<struct iovec>* iov, std::string_view text) {
+    if (!text.empty())
+        iov->push_back(iovec{const_cast<char*>(text.data()), text.length()});
+}
+
+}  // namespace
+
+// Appends the request head to iov as pieces pointing into the request
+// itself, so it can go out with one writev and no copying. The request
+// must outlive iov and not change in the meantime.
+void Request::Serialize(std::vector<struct iovec>* iov) const {
+    Append(iov, method_);
+    Append(iov, " ");
+    // An empty path is the root (RFC 9112 section 3.2.1).
+    Append(iov, uri_.Path.empty() ? std::string_view("/") : std::string_view(uri_.Path));
+    Append(iov, uri_.QueryString);
+    Append(iov, " HTTP/1.1\r\nHost: ");
+    // An IPv6 literal goes back in its brackets, and a port that isn't the
+    // scheme's default is part of the authority (RFC 9110 section 7.2).
+    bool ipv6 = uri_.Host.find(':') != std::string::npos;
+    Append(iov, ipv6 ? "[" : "");
+    Append(iov, uri_.Host);
+    Append(iov, ipv6 ? "]" : "");
+    bool https = EqualsIgnoreCase(uri_.Protocol, "https");
+    if (!uri_.Port.empty() && uri_.Port != (https ? "443" : "80")) {
+        Append(iov, ":");
+        Append(iov, uri_.Port);
+    }
+    Append(iov, "\r\n");
+
+    std::string_view wire;
+    if (headers_.Wire(&wire)) {
+        Append(iov, wire);
+    } else {
+        for (const auto& field : headers_) {
+            Append(iov, field.name);
+            Append(iov, ": ");
+            Append(iov, field.value);
+            Append(iov, "\r\n");
+        }
+    }
+    if (body_kind_ != kNoBody && !headers_.Has(kContentLength) && !headers_.Has(kTransferEncoding))
+        Append(iov, framing_);
+    if (ExpectsContinue() && !headers_.Has(kExpect))
+        Append(iov, "Expect: 100-continue\r\n");
+    Append(iov, "\r\n");
+    // Other kinds of body are the sender's to send.
+    if (body_kind_ == kMemoryBody)
+        Append(iov, body_);
+}
+
+void Request::SetBody(std::string body) {
+    body_kind_ = kMemoryBody;
+    body_ = std::move(body);
+    body_length_ = body_.length();
+    framing_ = "Content-Length: " + std::to_string(body_length_) + "\r\n";
+    producer_ = nullptr;
+}
+
+bool Request::SetBodyFile(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) == -1 || !S_ISREG(st.st_mode))
+        return false;
+    body_kind_ = kFileBody;
+    body_ = path;
+    body_length_ = st.st_size;
+    framing_ = "Content-Length: " + std::to_string(body_length_) + "\r\n";
+    producer_ = nullptr;
+    return true;
+}
+
+void Request::SetBodyProducer(BodyProducer producer) {
+    body_kind_ = kProducedBody;
+    body_.clear();
+    body_length_ = -1;
+    framing_ = "Transfer-Encoding: chunked\r\n";
+    producer_ = std::move(producer);
+}
+
+void Request::CopyBody(const Request& other) {
+    body_kind_ = other.body_kind_;
+    body_ = other.body_;
+    body_length_ = other.body_length_;
+    producer_ = other.producer_;
+    framing_ = other.framing_;
+}
+
+// Whether to wait for 100 Continue before sending the body: if the caller
+// asked, or for a large file or a produced body.
+bool Request::ExpectsContinue() const {
+    if (headers_.Has(kExpect))
+        return HasToken(headers_.Get(kExpect), "100-continue");
+    return (body_kind_ == kFileBody && body_length_ >= kExpectMin) || body_kind_ == kProducedBody;
+}
+
+// Whether sending the request twice has the same effect as sending it
+// once (RFC 9110 section 9.2.2), which makes it safe to retry.
+bool Request::Idempotent() const {
+    return method_ == "GET" || method_ == "HEAD" || method_ == "PUT" || method_ == "DELETE" ||
+           method_ == "OPTIONS" || method_ == "TRACE";
+}
+
+std::string Request::ToString() const {
+    std::vector<struct iovec> iov;
+    Serialize(&iov);
+    std::string ret;
+    for (const struct iovec& v : iov)
+        ret.append(static_cast<const char*>(v.iov_base), v.iov_len);
+    return ret;
+}
+
+bool Response::OK() const {
+    return ((status_code_ >= 200) && (status_code_ < 300));
+}
+
+// The body length the server announced, or -1 if there is none or it
+// isn't a plain number.
+int64_t Response::ContentLength() const {
+    std::string_view length = headers_.Get(kContentLength);
+    int64_t value = -1;
+    auto result = std::from_chars(length.data(), length.data() + length.length(), value);
+    if (length.empty() || result.ec != std::errc() || result.ptr != length.data() + length.length())
+        return -1;
+    return value;
+}
+
+// Parses "Content-Range: bytes first-last/total". total is -1 when the
+// server gives it as "*". Any of the outputs may be NULL.
+bool Response::ContentRange(int64_t* first, int64_t* last, int64_t* total) const {
+    std::string_view range = headers_.Get(kContentRange);
+    if (range.compare(0, 6, "bytes ") != 0)
+        return false;
+    range.remove_prefix(6);
+    const char* p = range.data();
+    const char* end = p + range.length();
+    int64_t a = 0, b = 0, t = -1;
+    auto r = std::from_chars(p, end, a);
+    if (r.ec != std::errc() || r.ptr == end || *r.ptr != '-')
+        return false;
+    r = std::from_chars(r.ptr + 1, end, b);
+    if (r.ec != std::errc() || r.ptr == end || *r.ptr != '/' || b < a)
+        return false;
+    if (!(end - r.ptr == 2 && r.ptr[1] == '*')) {
+        r = std::from_chars(r.ptr + 1, end, t);
+        if (r.ec != std::errc() || r.ptr != end || t <= b)
+            return false;
+    }
+    if (first)
+        *first = a;
+    if (last)
+        *last = b;
+    if (total)
+        *total = t;
+    return true;
+}
+
+// Whether the body is chunked, which is only the case when chunked is the
+// last transfer coding applied.
+bool Response::Chunked() const {
+    std::string_view encoding = headers_.Get(kTransferEncoding);
+    size_t comma = encoding.rfind(',');
+    return HasToken(comma == std::string_view::npos ? encoding : encoding.substr(comma + 1), "chunked");
+}
+
+// HTTP/1.1 connections are persistent unless the server says otherwise;
+// HTTP/1.0 ones only if it asks for it.
+bool Response::KeepAlive() const {
+    std::string_view connection = headers_.Get(kConnection);
+    if (minor_version_ == 0)
+        return HasToken(connection, "keep-alive");
+    return !HasToken(connection, "close");
+}
+
+std::string Response::ToString() const {
+    return "Status: " + std::to_string(status_code_);
+}
+
+// Parses a response head from the start of buf. Returns the number of bytes
+// it took up, 0 if buf doesn't hold all of it yet, -1 if it's malformed, or
+// ResponseHead::kTooManyFields.
+// Only a complete head replaces what the Response held before.
+int Response::Parse(std::string_view buf) {
+    ResponseHead head;
+    int len = ParseHead(buf, &head);
+    if (len <= 0)
+        return len;
+
+    status_code_ = head.status;
+    minor_version_ = head.minor_version;
+    recv_bytes_ = 0;
+    headers_.Assign(buf.substr(0, len), head.fields, head.nfields);
+    return len;
+}
+
+}  // namespace http
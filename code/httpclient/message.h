@@ -0,0 +1,102 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_MESSAGE_H_
+#define CODE_HTTPCLIENT_MESSAGE_H_
+
+#include <sys/uio.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "headers.h"
+#include "uri.h"
+
+namespace http {
+
+// A request body is one of: bytes held in memory, a file sent with
+// sendfile, or pieces from a producer, sent chunked unless the caller gave
+// a Content-Length. Memory and file bodies get a Content-Length. File and
+// produced bodies of kExpectMin bytes or more (or of unknown length) are
+// announced with Expect: 100-continue, so a server that is going to refuse
+// them can say so before they are sent. Framing headers the caller adds
+// itself take precedence.
+class Request {
+ public:
+  enum BodyKind { kNoBody, kMemoryBody, kFileBody, kProducedBody };
+  // Puts the next piece of the body in chunk, leaving it empty at the end.
+  // Returning false abandons the request.
+  typedef std::function<bool(std::string* chunk)> BodyProducer;
+
+  static constexpr int64_t kExpectMin = 1024 * 1024;
+
+  explicit Request(const URI& uri, const std::string& method = "GET") : method_{method}, uri_{uri} {}
+  const HeaderMap& Headers() const { return headers_; }
+  const URI& Uri() const { return uri_; }
+  const std::string& Method() const { return method_; }
+  void AddHeader(std::string_view key, std::string_view value) { headers_.Add(key, value); }
+  bool HasHeader(const HeaderName& key) const { return headers_.Has(key); }
+  bool Idempotent() const;
+  void Serialize(std::vector<struct iovec>*) const;
+  std::string ToString() const;
+
+  void SetBody(std::string body);
+  // False if path can't be read.
+  bool SetBodyFile(const std::string& path);
+  void SetBodyProducer(BodyProducer producer);
+  void CopyBody(const Request& other);
+
+  BodyKind Body() const { return body_kind_; }
+  const std::string& BodyData() const { return body_; }
+  const std::string& BodyPath() const { return body_; }
+  const BodyProducer& Producer() const { return producer_; }
+  // -1 for a produced body.
+  int64_t BodyLength() const { return body_length_; }
+  bool ChunkedBody() const { return body_kind_ == kProducedBody && !headers_.Has(kContentLength); }
+  bool ExpectsContinue() const;
+
+ private:
+  std::string method_;
+  URI uri_;
+  HeaderMap headers_;
+  BodyKind body_kind_ = kNoBody;
+  std::string body_;  // the bytes, or the file's path
+  int64_t body_length_ = 0;
+  BodyProducer producer_;
+  std::string framing_;  // the header line Serialize adds
+};
+
+class Response {
+ public:
+  Response() {}
+  explicit Response(int status_code) : status_code_{status_code} {}
+
+  int Parse(std::string_view);
+  void AddHeader(std::string_view key, std::string_view value) { headers_.Add(key, value); }
+  void SetStatusCode(int status_code) { status_code_ = status_code; }
+  int StatusCode() const { return status_code_; }
+  void SetRecvBytes(int64_t recv_bytes) { recv_bytes_ = recv_bytes; }
+  int64_t RecvBytes() const { return recv_bytes_; }
+  const HeaderMap& Headers() const { return headers_; }
+  std::string ToString() const;
+  bool OK() const;
+
+  int64_t ContentLength() const;
+  bool ContentRange(int64_t*, int64_t*, int64_t*) const;
+  bool Chunked() const;
+  bool KeepAlive() const;
+  std::string_view ETag() const { return headers_.Get(kETag); }
+  std::string_view Location() const { return headers_.Get(kLocation); }
+  std::string_view LastModified() const { return headers_.Get(kLastModified); }
+
+ private:
+  int status_code_ = -1;
+  int minor_version_ = 1;
+  int64_t recv_bytes_ = 0;
+  HeaderMap headers_;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_MESSAGE_H_
@@ -0,0 +1,278 @@
+// Copyright hopkiw 2026
+#include "parser.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "headers.h"
+
+namespace http {
+
+namespace {
+
+// Parses a chunk-size line: hex digits, then optionally whitespace and
+// ";" extensions, which are ignored (RFC 9112 section 7.1.1). Rejects
+// signs, "0x" and sizes that don't fit.
+bool ParseChunkSize(std::string_view line, size_t* size) {
+    size_t n = 0, i = 0;
+    for (; i < line.length(); ++i) {
+        char c = line[i];
+        int digit;
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            digit = c - 'A' + 10;
+        else
+            break;
+        if (n > (SIZE_MAX >> 4))
+            return false;
+        n = n << 4 | digit;
+    }
+    if (i == 0)
+        return false;
+    while (i < line.length() && (line[i] == ' ' || line[i] == '\t'))
+        ++i;
+    if (i < line.length() && line[i] != ';')
+        return false;
+    *size = n;
+    return true;
+}
+
+}  // namespace
+
+void ResponseParser::Fail(const std::string& why) {
+    std::cout << "invalid response: " << why << std::endl;
+    state_ = kError;
+}
+
+// Accumulates bytes into line until a '\n' is seen. Returns true with the
+// line (CRLF stripped) once it is complete. A line longer than kMaxLine
+// fails the response.
+bool ResponseParser::TakeLine(const char* data, size_t len, size_t* pos, std::string* line) {
+    const char* start = data + *pos;
+    const char* nl = static_cast<const char*>(memchr(start, '\n', len - *pos));
+    size_t n = nl == NULL ? len - *pos : nl - start;
+    if (line->length() + n > kMaxLine) {
+        Fail("chunk or trailer line too long");
+        *pos = len;
+        return false;
+    }
+    if (nl == NULL) {
+        line->append(start, n);
+        *pos = len;
+        return false;
+    }
+    line->append(start, n);
+    *pos = nl - data + 1;
+    if (!line->empty() && line->back() == '\r')
+        line->pop_back();
+    return true;
+}
+
+void ResponseParser::Body(const char* data, size_t len) {
+    if (!sink_->Write(data, len))
+        Fail("body sink failed");
+    body_bytes_ += len;
+}
+
+size_t ResponseParser::Feed(const char* data, size_t len) {
+    size_t pos = 0;
+    if (len > 0)
+        started_ = true;
+
+    while (pos < len && state_ != kDone && state_ != kError) {
+        switch (state_) {
+        case kHead: {
+            std::string_view rest(data + pos, len - pos);
+            int n;
+            if (head_.empty()) {
+                // Usually the whole head arrives in one segment and can be
+                // parsed where it lies.
+                n = res_->Parse(rest);
+                if (n == 0) {
+                    head_.assign(rest);
+                    scan_ = 0;
+                    FindHeadEnd(head_, &scan_);
+                    pos = len;
+                    break;
+                }
+                if (n > 0)
+                    pos += n;
+            } else {
+                head_.append(rest);
+                size_t end = FindHeadEnd(head_, &scan_);
+                if (end == 0) {
+                    pos = len;
+                    if (head_.length() > kMaxHead)
+                        Fail("header block too large");
+                    break;
+                }
+                // Give back whatever followed the blank line.
+                pos = len - (head_.length() - end);
+                n = res_->Parse(std::string_view(head_.data(), end));
+                head_.clear();
+            }
+            if (n == ResponseHead::kTooManyFields) {
+                Fail("too many headers (more than " + std::to_string(ResponseHead::kMaxFields) + ")");
+                break;
+            }
+            if (n < 0) {
+                Fail("bad status line or headers");
+                break;
+            }
+            // 1xx responses are interim; the real one follows.
+            if (res_->StatusCode() >= 100 && res_->StatusCode() < 200 && res_->StatusCode() != 101)
+                break;
+            StartBody();
+            break;
+        }
+        case kLengthBody: {
+            size_t n = std::min(remaining_, len - pos);
+            Body(data + pos, n);
+            remaining_ -= n;
+            pos += n;
+            if (remaining_ == 0 && state_ != kError)
+                state_ = kDone;
+            break;
+        }
+        case kChunkSize: {
+            if (!TakeLine(data, len, &pos, &line_))
+                break;
+            if (!ParseChunkSize(line_, &remaining_)) {
+                Fail("bad chunk size \"" + line_ + "\"");
+                break;
+            }
+            line_.clear();
+            state_ = remaining_ == 0 ? kTrailers : kChunkData;
+            break;
+        }
+        case kChunkData: {
+            size_t n = std::min(remaining_, len - pos);
+            Body(data + pos, n);
+            remaining_ -= n;
+            pos += n;
+            if (remaining_ == 0 && state_ != kError)
+                state_ = kChunkDataEnd;
+            break;
+        }
+        case kChunkDataEnd: {
+            if (!TakeLine(data, len, &pos, &line_))
+                break;
+            if (!line_.empty()) {
+                Fail("missing CRLF after chunk data");
+                break;
+            }
+            state_ = kChunkSize;
+            break;
+        }
+        case kTrailers: {
+            if (!TakeLine(data, len, &pos, &line_))
+                break;
+            if (line_.empty()) {
+                state_ = kDone;
+                break;
+            }
+            size_t colon = line_.find(':');
+            if (colon == std::string::npos) {
+                Fail("bad trailer \"" + line_ + "\"");
+                break;
+            }
+            trailer_bytes_ += line_.length();
+            if (trailer_bytes_ > kMaxHead) {
+                Fail("trailers too large");
+                break;
+            }
+            size_t value = line_.find_first_not_of(" \t", colon + 1);
+            res_->AddHeader(line_.substr(0, colon), value == std::string::npos ? "" : line_.substr(value));
+            line_.clear();
+            break;
+        }
+        case kUntilClose:
+            Body(data + pos, len - pos);
+            pos = len;
+            break;
+        case kDone:
+        case kError:
+            break;
+        }
+    }
+    res_->SetRecvBytes(body_bytes_);
+    return pos;
+}
+
+// Picks the body framing from the headers, RFC 7230 section 3.3.3 order:
+// bodiless statuses, chunked, Content-Length, then read until close.
+void ResponseParser::StartBody() {
+    int status = res_->StatusCode();
+    int64_t content_length = -1;
+
+    if (head_request_ || status == 204 || status == 304) {
+        state_ = kDone;
+    } else if (res_->Headers().Has(kTransferEncoding)) {
+        if (res_->Chunked()) {
+            state_ = kChunkSize;
+        } else {
+            until_close_ = true;
+            state_ = kUntilClose;
+        }
+    } else if (res_->Headers().Has(kContentLength)) {
+        content_length = res_->ContentLength();
+        if (content_length < 0) {
+            Fail("bad Content-Length \"" + std::string(res_->Headers().Get(kContentLength)) + "\"");
+            return;
+        }
+        remaining_ = content_length;
+        state_ = remaining_ == 0 ? kDone : kLengthBody;
+    } else {
+        until_close_ = true;
+        state_ = kUntilClose;
+    }
+
+    if (head_request_ || status == 204 || status == 304)
+        return;
+    body_begun_ = true;
+    sink_->Head(*res_);
+    if (!sink_->Begin(content_length))
+        Fail("body sink failed");
+}
+
+// How many upcoming bytes are plain body data that the caller may move
+// straight into the sink, bypassing Feed.
+size_t ResponseParser::Direct() const {
+    switch (state_) {
+    case kLengthBody:
+    case kChunkData:
+        return remaining_;
+    case kUntilClose:
+        return SIZE_MAX;
+    default:
+        return 0;
+    }
+}
+
+// Accounts for n body bytes the caller moved into the sink itself.
+void ResponseParser::Skip(size_t n) {
+    body_bytes_ += n;
+    res_->SetRecvBytes(body_bytes_);
+    if (state_ == kUntilClose)
+        return;
+    remaining_ -= n;
+    if (remaining_ == 0)
+        state_ = state_ == kLengthBody ? kDone : kChunkDataEnd;
+}
+
+// The peer closed the connection. That is how an unframed body ends; for
+// anything else it means the response was cut short.
+bool ResponseParser::Finish() {
+    if (state_ == kUntilClose)
+        state_ = kDone;
+    return state_ == kDone;
+}
+
+}  // namespace http
@@ -0,0 +1,76 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_PARSER_H_
+#define CODE_HTTPCLIENT_PARSER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "message.h"
+#include "sink.h"
+
+namespace http {
+
+// Incremental HTTP/1.1 response reader. Bytes are fed in as they come off
+// the socket, split at any point, and the parser walks status line ->
+// headers -> body -> trailers, handing body bytes to a BodySink. Feed stops
+// at the end of the response so anything after it is left to the caller.
+class ResponseParser {
+ public:
+  enum State {
+    kHead,          // status line and headers, up to the blank line
+    kLengthBody,    // Content-Length bytes
+    kChunkSize,     // chunk-size [; ext] CRLF
+    kChunkData,
+    kChunkDataEnd,  // CRLF after chunk data
+    kTrailers,      // trailer fields after the last chunk
+    kUntilClose,    // no framing; body runs until the server closes
+    kDone,
+    kError,
+  };
+
+  ResponseParser(Response* res, bool head_request, BodySink* sink)
+      : res_{res}, head_request_{head_request}, sink_{sink} {}
+
+  size_t Feed(const char*, size_t);
+  bool Finish();
+  size_t Direct() const;
+  void Skip(size_t);
+
+  State GetState() const { return state_; }
+  bool Done() const { return state_ == kDone; }
+  bool Failed() const { return state_ == kError; }
+  bool Started() const { return started_; }
+  // Whether the sink has been given a body, and so needs Finish.
+  bool BodyBegun() const { return body_begun_; }
+  bool Reusable() const { return state_ == kDone && !until_close_ && res_->KeepAlive(); }
+  size_t BodyBytes() const { return body_bytes_; }
+
+ private:
+  static constexpr size_t kMaxHead = 64 * 1024;
+  // A chunk-size or trailer line; trailers together get kMaxHead.
+  static constexpr size_t kMaxLine = 8 * 1024;
+
+  bool TakeLine(const char*, size_t, size_t*, std::string*);
+  void StartBody();
+  void Body(const char*, size_t);
+  void Fail(const std::string&);
+
+  Response* res_;
+  bool head_request_;
+  BodySink* sink_;
+  State state_ = kHead;
+  bool started_ = false;
+  bool body_begun_ = false;
+  bool until_close_ = false;
+  std::string head_;
+  size_t scan_ = 0;
+  std::string line_;
+  size_t remaining_ = 0;
+  size_t trailer_bytes_ = 0;
+  size_t body_bytes_ = 0;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_PARSER_H_
@@ -0,0 +1,99 @@
+// Copyright hopkiw 2026
+#include "pool.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+
+namespace http {
+
+ConnectionPool::~ConnectionPool() {
+    for (auto& entry : idle_) {
+        for (auto& conn : entry.second)
+            close(conn.fd);
+    }
+}
+
+// Checks out a connection for key. If an idle one passes the health check it
+// is handed back with its fd set; otherwise conn->fd is -1 and the caller is
+// expected to dial. Returns false when key already has max_per_host_
+// connections open.
+bool ConnectionPool::Acquire(const std::string& key, Connection* conn) {
+    Expire(std::chrono::steady_clock::now());
+
+    auto& idle = idle_[key];
+    while (!idle.empty()) {
+        Connection candidate = idle.back();  // most recently used is warmest
+        idle.pop_back();
+        if (Healthy(candidate.fd)) {
+            *conn = candidate;
+            return true;
+        }
+        close(candidate.fd);
+        --open_[key];
+    }
+
+    if (open_[key] >= max_per_host_)
+        return false;
+
+    ++open_[key];
+    *conn = Connection();
+    conn->key = key;
+    return true;
+}
+
+// Returns a checked out connection. Reusable connections go back on the idle
+// list, anything else is closed and its slot freed.
+void ConnectionPool::Release(Connection* conn, bool reusable) {
+    if (reusable && conn->fd != -1) {
+        conn->idle_since = std::chrono::steady_clock::now();
+        idle_[conn->key].push_back(*conn);
+    } else {
+        if (conn->fd != -1)
+            close(conn->fd);
+        --open_[conn->key];
+    }
+    *conn = Connection();
+}
+
+size_t ConnectionPool::Open(const std::string& key) const {
+    auto it = open_.find(key);
+    return it == open_.end() ? 0 : it->second;
+}
+
+size_t ConnectionPool::Idle(const std::string& key) const {
+    auto it = idle_.find(key);
+    return it == idle_.end() ? 0 : it->second.size();
+}
+
+void ConnectionPool::Expire(std::chrono::steady_clock::time_point now) {
+    for (auto& entry : idle_) {
+        auto& idle = entry.second;
+        while (!idle.empty() && now - idle.front().idle_since > idle_timeout_) {
+            close(idle.front().fd);
+            idle.pop_front();
+            --open_[entry.first];
+        }
+    }
+}
+
+// An idle connection should have nothing to read. Readable means the server
+// either closed it (recv returns 0) or sent something we didn't ask for;
+// neither is safe to reuse.
+bool ConnectionPool::Healthy(int fd) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    int ret = poll(&pfd, 1, 0);
+    if (ret == 0)
+        return true;
+    if (ret == -1 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)))
+        return false;
+
+    char c;
+    ssize_t n = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    return n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+}  // namespace http
@@ -0,0 +1,51 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_POOL_H_
+#define CODE_HTTPCLIENT_POOL_H_
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <string>
+
+namespace http {
+
+// A socket to one host:port, either checked out by a Client or idle in a
+// ConnectionPool.
+struct Connection {
+  int fd = -1;
+  std::string key;
+  int requests = 0;
+  std::chrono::steady_clock::time_point idle_since;
+};
+
+// Keeps idle HTTP/1.1 connections around so later requests to the same
+// host:port can skip the TCP handshake.
+class ConnectionPool {
+ public:
+  ConnectionPool() {}
+  ConnectionPool(size_t max_per_host, std::chrono::seconds idle_timeout)
+      : max_per_host_{max_per_host}, idle_timeout_{idle_timeout} {}
+  ConnectionPool(const ConnectionPool&) = delete;
+  ConnectionPool& operator=(const ConnectionPool&) = delete;
+  ~ConnectionPool();
+
+  static std::string Key(const std::string& host, const std::string& port) { return host + ":" + port; }
+
+  bool Acquire(const std::string&, Connection*);
+  void Release(Connection*, bool);
+  size_t Open(const std::string& key) const;
+  size_t Idle(const std::string& key) const;
+
+ private:
+  static bool Healthy(int fd);
+  void Expire(std::chrono::steady_clock::time_point);
+
+  size_t max_per_host_ = 6;
+  std::chrono::seconds idle_timeout_{30};
+  std::map<std::string, std::deque<Connection>> idle_;
+  std::map<std::string, size_t> open_;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_POOL_H_
@@ -0,0 +1,153 @@
+// Copyright hopkiw 2026
+#include "resolver.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace http {
+
+Resolver::Resolver(std::chrono::seconds ttl, std::chrono::seconds negative_ttl)
+    : ttl_{ttl}, negative_ttl_{negative_ttl}, lookup_{SystemLookup} {}
+
+// The resolver Clients and Fetchers use unless they are given another one.
+Resolver& Resolver::Default() {
+    static Resolver resolver;
+    return resolver;
+}
+
+int Resolver::SystemLookup(const std::string& host, const std::string& port, int family,
+                           std::vector<Address>* addrs) {
+    struct addrinfo hints;
+    struct addrinfo *res, *rp;
+    memset(&hints, 0, sizeof(hints));
+
+    hints.ai_family = family;
+    hints.ai_socktype = SOCK_STREAM;
+
+    int ret = getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+    if (ret != 0)
+        return ret;
+
+    for (rp = res; rp != NULL; rp = rp->ai_next) {
+        Address a;
+        a.family = rp->ai_family;
+        a.len = rp->ai_addrlen;
+        memcpy(&a.addr, rp->ai_addr, rp->ai_addrlen);
+        addrs->push_back(a);
+    }
+    freeaddrinfo(res);
+    return 0;
+}
+
+// Looks up host:port restricted to family (AF_UNSPEC for any), from the
+// cache when it can. Returns 0 with addrs filled in, or an EAI_* code.
+int Resolver::Resolve(const std::string& host, const std::string& port, int family, std::vector<Address>* addrs) {
+    std::string key = host + ":" + port + "/" + std::to_string(family);
+    auto now = std::chrono::steady_clock::now();
+    LookupFn lookup;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = cache_.find(key);
+        if (it != cache_.end() && it->second.expires > now) {
+            ++hits_;
+            if (it->second.error != 0)
+                ++negative_hits_;
+            *addrs = it->second.addrs;
+            return it->second.error;
+        }
+        lookup = lookup_;
+    }
+
+    // Resolve without holding the lock; two threads missing on the same
+    // name at once both look it up, which is harmless.
+    ++misses_;
+    Entry entry;
+    entry.error = lookup(host, port, family, &entry.addrs);
+#ifdef EAI_NODATA
+    bool negative = entry.error == EAI_NONAME || entry.error == EAI_NODATA;
+#else
+    bool negative = entry.error == EAI_NONAME;
+#endif
+    if (entry.error == 0 || negative) {
+        entry.expires = now + (entry.error == 0 ? ttl_ : negative_ttl_);
+        std::lock_guard<std::mutex> lock(mu_);
+        cache_[key] = entry;
+    }
+    *addrs = entry.addrs;
+    return entry.error;
+}
+
+void Resolver::SetLookup(LookupFn lookup) {
+    std::lock_guard<std::mutex> lock(mu_);
+    lookup_ = lookup;
+    cache_.clear();
+}
+
+// Answers lookups from a file in /etc/hosts format ("address name
+// [aliases...]", '#' comments) instead of DNS. Names not in the file come
+// back as EAI_NONAME.
+bool Resolver::LoadHostsFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cout << "Failed to open " << path << std::endl;
+        return false;
+    }
+
+    auto hosts = std::make_shared<std::multimap<std::string, std::string>>();
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string ip, name;
+        if (!(fields >> ip))
+            continue;
+        while (fields >> name)
+            hosts->insert({name, ip});
+    }
+
+    SetLookup([hosts](const std::string& host, const std::string& port, int family, std::vector<Address>* addrs) {
+        auto range = hosts->equal_range(host);
+        for (auto it = range.first; it != range.second; ++it) {
+            Address a;
+            memset(&a.addr, 0, sizeof(a.addr));
+            auto sin = reinterpret_cast<struct sockaddr_in*>(&a.addr);
+            auto sin6 = reinterpret_cast<struct sockaddr_in6*>(&a.addr);
+            if ((family == AF_UNSPEC || family == AF_INET)
+                    && inet_pton(AF_INET, it->second.c_str(), &sin->sin_addr) == 1) {
+                a.family = sin->sin_family = AF_INET;
+                sin->sin_port = htons(atoi(port.c_str()));
+                a.len = sizeof(*sin);
+            } else if ((family == AF_UNSPEC || family == AF_INET6)
+                    && inet_pton(AF_INET6, it->second.c_str(), &sin6->sin6_addr) == 1) {
+                a.family = sin6->sin6_family = AF_INET6;
+                sin6->sin6_port = htons(atoi(port.c_str()));
+                a.len = sizeof(*sin6);
+            } else {
+                continue;
+            }
+            addrs->push_back(a);
+        }
+        return addrs->empty() ? EAI_NONAME : 0;
+    });
+    return true;
+}
+
+void Resolver::Clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    cache_.clear();
+}
+
+}  // namespace http
@@ -0,0 +1,75 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_RESOLVER_H_
+#define CODE_HTTPCLIENT_RESOLVER_H_
+
+#include <sys/socket.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace http {
+
+// One resolved socket address, copied out of getaddrinfo's list so it can
+// outlive it.
+struct Address {
+  int family = AF_UNSPEC;
+  socklen_t len = 0;
+  struct sockaddr_storage addr;
+
+  const struct sockaddr* SockAddr() const { return reinterpret_cast<const struct sockaddr*>(&addr); }
+};
+
+// Caches host:port lookups. Answers are kept for ttl; "no such host"
+// answers are kept for negative_ttl so a bad name in a batch doesn't hit
+// the resolver over and over. Transient failures aren't cached. Safe to
+// share between threads.
+//
+// Lookups go to getaddrinfo unless SetLookup or LoadHostsFile swap in
+// something else, which is how tests point the client at a stub.
+class Resolver {
+ public:
+  // Fills addrs and returns 0, or returns a getaddrinfo EAI_* code.
+  typedef std::function<int(const std::string&, const std::string&, int, std::vector<Address>*)> LookupFn;
+
+  Resolver() : Resolver(std::chrono::seconds(60), std::chrono::seconds(10)) {}
+  Resolver(std::chrono::seconds ttl, std::chrono::seconds negative_ttl);
+
+  static Resolver& Default();
+
+  int Resolve(const std::string&, const std::string&, int, std::vector<Address>*);
+  void SetLookup(LookupFn lookup);
+  bool LoadHostsFile(const std::string&);
+  void Clear();
+
+  uint64_t Hits() const { return hits_; }
+  uint64_t Misses() const { return misses_; }
+  uint64_t NegativeHits() const { return negative_hits_; }
+
+ private:
+  struct Entry {
+    int error = 0;
+    std::vector<Address> addrs;
+    std::chrono::steady_clock::time_point expires;
+  };
+
+  static int SystemLookup(const std::string&, const std::string&, int, std::vector<Address>*);
+
+  std::chrono::seconds ttl_;
+  std::chrono::seconds negative_ttl_;
+  LookupFn lookup_;
+  std::mutex mu_;
+  std::unordered_map<std::string, Entry> cache_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> negative_hits_{0};
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_RESOLVER_H_
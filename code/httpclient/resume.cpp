@@ -0,0 +1,90 @@
+// Copyright hopkiw 2026
+#include "resume.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "headers.h"
+
+namespace http {
+
+int64_t ResumeSink::Prepare(const std::string& path, Request* request) {
+    std::ifstream in(Sidecar(path));
+    struct stat st;
+    if (!in.is_open() || stat(path.c_str(), &st) == -1 || st.st_size == 0)
+        return 0;
+
+    std::string etag, last_modified, line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 6, "etag: ") == 0)
+            etag = line.substr(6);
+        else if (line.compare(0, 15, "last-modified: ") == 0)
+            last_modified = line.substr(15);
+    }
+
+    // If-Range needs a strong validator: a weak ETag could match a body
+    // whose bytes differ.
+    std::string validator = etag.compare(0, 2, "W/") == 0 ? "" : etag;
+    if (validator.empty())
+        validator = last_modified;
+    if (validator.empty()) {
+        Discard(path);
+        return 0;
+    }
+
+    request->AddHeader("Range", "bytes=" + std::to_string(st.st_size) + "-");
+    request->AddHeader("If-Range", validator);
+    return st.st_size;
+}
+
+void ResumeSink::Discard(const std::string& path) {
+    unlink(Sidecar(path).c_str());
+}
+
+bool ResumeSink::Begin(int64_t length) {
+    int status = res_->StatusCode();
+    if (status != 200 && status != 206) {
+        // Not the body we're after; leave the partial file alone.
+        discard_ = true;
+        return true;
+    }
+
+    if (status == 206) {
+        int64_t first = -1;
+        if (!res_->ContentRange(&first, NULL, NULL) || first != offset_) {
+            std::cout << "server sent a range that doesn't start at " << offset_ << std::endl;
+            return false;
+        }
+        file_->StartAt(offset_);
+        resumed_ = true;
+    }
+
+    std::string_view etag = res_->ETag();
+    std::string_view last_modified = res_->LastModified();
+    if (etag.empty() && last_modified.empty()) {
+        Discard(path_);
+    } else {
+        std::ofstream out(Sidecar(path_), std::ios::trunc);
+        if (!etag.empty())
+            out << "etag: " << etag << "\n";
+        if (!last_modified.empty())
+            out << "last-modified: " << last_modified << "\n";
+    }
+    return file_->Begin(length);
+}
+
+bool ResumeSink::Finish() {
+    if (discard_)
+        return true;
+    if (!file_->Finish())
+        return false;
+    Discard(path_);
+    return true;
+}
+
+}  // namespace http
@@ -0,0 +1,53 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_RESUME_H_
+#define CODE_HTTPCLIENT_RESUME_H_
+
+#include <cstdint>
+#include <string>
+
+#include "message.h"
+#include "sink.h"
+
+namespace http {
+
+// Lets an interrupted download pick up where it stopped. While a body is
+// being written to path, a sidecar file next to it (path + ".resume")
+// holds the response's validator. Prepare finds such a leftover and turns
+// the next request into "Range: bytes=N-" with If-Range, N being what
+// made it to disk. The sink then appends if the server answers 206 and
+// starts the file over if it answers 200, i.e. the resource changed. The
+// sidecar goes once the body is complete.
+class ResumeSink : public BodySink {
+ public:
+  ResumeSink(const std::string& path, int64_t offset, const Response* res, FileSink* file)
+      : path_{path}, offset_{offset}, res_{res}, file_{file} {}
+
+  // Adds Range and If-Range to request if path holds a partial download
+  // that can be resumed. Returns the offset to resume from, or 0.
+  static int64_t Prepare(const std::string& path, Request* request);
+  // Forgets a partial download, e.g. after the server refused the range.
+  static void Discard(const std::string& path);
+
+  void Head(const Response& res) override { file_->Head(res); }
+  bool Begin(int64_t) override;
+  bool Write(const char* data, size_t len) override { return discard_ || file_->Write(data, len); }
+  bool Finish() override;
+  bool CanSplice() const override { return !discard_ && file_->CanSplice(); }
+  ssize_t Splice(int sockfd, size_t len) override { return file_->Splice(sockfd, len); }
+
+  bool Resumed() const { return resumed_; }
+
+ private:
+  static std::string Sidecar(const std::string& path) { return path + ".resume"; }
+
+  std::string path_;
+  int64_t offset_;
+  const Response* res_;
+  FileSink* file_;
+  bool resumed_ = false;
+  bool discard_ = false;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_RESUME_H_
@@ -0,0 +1,175 @@
+// Copyright hopkiw 2026
+#include "scheduler.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+namespace http {
+
+namespace {
+
+// A quarter second's worth, so a budget is met smoothly rather than in
+// bursts, but never less than one request or a few reads.
+TokenBucket Bucket(double rate, double least) {
+    if (rate <= 0)
+        return TokenBucket();
+    return TokenBucket(rate, std::max(rate / 4, least));
+}
+
+}  // namespace
+
+void TokenBucket::Refill(Clock::time_point now) {
+    if (last_ != Clock::time_point() && now > last_)
+        tokens_ = std::min(burst_, tokens_ + rate_ * std::chrono::duration<double>(now - last_).count());
+    last_ = now;
+}
+
+double TokenBucket::Available(Clock::time_point now) {
+    if (!Limited())
+        return std::numeric_limits<double>::infinity();
+    Refill(now);
+    return tokens_;
+}
+
+void TokenBucket::Take(double tokens, Clock::time_point now) {
+    if (!Limited())
+        return;
+    Refill(now);
+    tokens_ -= tokens;
+}
+
+TokenBucket::Clock::duration TokenBucket::Wait(Clock::time_point now) {
+    double missing = 1 - Available(now);
+    if (missing <= 0)
+        return Clock::duration(0);
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(missing / rate_));
+}
+
+Scheduler::Scheduler(const Budget& budget)
+    : budget_{budget}, bytes_{Bucket(budget.bytes_per_sec, 4 * kMinRead)},
+      requests_{Bucket(budget.requests_per_sec, 1)} {}
+
+Scheduler::Host& Scheduler::For(const std::string& host) {
+    auto it = hosts_.find(host);
+    if (it == hosts_.end()) {
+        Host fresh{Bucket(budget_.host_bytes_per_sec, 4 * kMinRead), Bucket(budget_.host_requests_per_sec, 1)};
+        it = hosts_.emplace(host, fresh).first;
+    }
+    return it->second;
+}
+
+bool Scheduler::Admit(const std::string& host, Clock::time_point now) {
+    Host& h = For(host);
+    if (requests_.Available(now) < 1 || h.requests.Available(now) < 1)
+        return false;
+    // A new request would only add to bytes already owed.
+    if (!MayRead(host, now))
+        return false;
+    requests_.Take(1, now);
+    h.requests.Take(1, now);
+    return true;
+}
+
+bool Scheduler::MayRead(const std::string& host, Clock::time_point now) {
+    return bytes_.Available(now) > 0 && For(host).bytes.Available(now) > 0;
+}
+
+size_t Scheduler::ReadSize(const std::string& host, size_t max, Clock::time_point now) {
+    Host& h = For(host);
+    if (!bytes_.Limited() && !h.bytes.Limited())
+        return max;
+    double room = max;
+    if (bytes_.Limited())
+        room = std::min(room, bytes_.Available(now));
+    if (h.bytes.Limited())
+        room = std::min(room, h.bytes.Available(now));
+    return std::min(max, std::max(kMinRead, static_cast<size_t>(std::max(room, 0.0))));
+}
+
+void Scheduler::Consumed(const std::string& host, size_t bytes, Clock::time_point now) {
+    bytes_.Take(bytes, now);
+    For(host).bytes.Take(bytes, now);
+    window_bytes_ += bytes;
+    total_bytes_ += bytes;
+}
+
+Scheduler::Clock::duration Scheduler::Wait(Clock::time_point now, Clock::duration limit) {
+    Clock::duration wait = limit;
+    if (bytes_.Limited() && bytes_.Available(now) <= 0)
+        wait = std::min(wait, bytes_.Wait(now));
+    if (requests_.Limited() && requests_.Available(now) < 1)
+        wait = std::min(wait, requests_.Wait(now));
+    for (auto& entry : hosts_) {
+        Host& h = entry.second;
+        if (h.bytes.Limited() && h.bytes.Available(now) <= 0)
+            wait = std::min(wait, h.bytes.Wait(now));
+        if (h.requests.Limited() && h.requests.Available(now) < 1)
+            wait = std::min(wait, h.requests.Wait(now));
+    }
+    return wait;
+}
+
+void Scheduler::Finished(std::chrono::nanoseconds first_byte) {
+    ++window_requests_;
+    window_first_byte_ += first_byte;
+}
+
+size_t Scheduler::Concurrency(size_t max, size_t active, size_t paused, Clock::time_point now) {
+    if (limit_ == 0) {
+        limit_ = std::min<size_t>(max, 2);
+        window_start_ = now;
+    }
+    double seconds = std::chrono::duration<double>(now - window_start_).count();
+    if (now - window_start_ < kInterval)
+        return std::min(limit_, max);
+
+    // Long transfers may all still be running; then there is no latency to
+    // go on this time.
+    bool queueing = false;
+    if (window_requests_ > 0) {
+        auto first_byte = window_first_byte_ / window_requests_;
+        if (best_first_byte_.count() == 0 || first_byte < best_first_byte_)
+            best_first_byte_ = first_byte;
+        // The slack keeps jitter on fast links from reading as queueing.
+        queueing = first_byte > 2 * best_first_byte_ + kSlack;
+    }
+
+    // Whether the budget, rather than the connection count, set the pace.
+    bool full;
+    if (budget_.bytes_per_sec > 0 || budget_.requests_per_sec > 0) {
+        full = (budget_.bytes_per_sec > 0 && window_bytes_ >= 0.95 * budget_.bytes_per_sec * seconds) ||
+               (budget_.requests_per_sec > 0 && window_requests_ >= 0.95 * budget_.requests_per_sec * seconds);
+    } else {
+        full = paused > 0;
+    }
+
+    if (queueing) {
+        congested_ = true;
+        limit_ = std::max<size_t>(1, limit_ * 3 / 4);
+    } else if (full) {
+        if (paused * 2 > active && limit_ > 1)
+            --limit_;
+    } else if (limit_ < max) {
+        limit_ = congested_ ? limit_ + 1 : limit_ * 2;
+    }
+    limit_ = std::min(limit_, max);
+    ++adjustments_;
+
+    window_start_ = now;
+    window_bytes_ = 0;
+    window_requests_ = 0;
+    window_first_byte_ = std::chrono::nanoseconds(0);
+    return limit_;
+}
+
+std::string Scheduler::ToString() const {
+    std::ostringstream out;
+    out << "scheduler: " << total_bytes_ << " bytes shaped, concurrency " << limit_ << " after "
+        << adjustments_ << " adjustments";
+    if (best_first_byte_.count() > 0)
+        out << ", best first byte " << best_first_byte_.count() / 1000 << "us";
+    return out.str();
+}
+
+}  // namespace http
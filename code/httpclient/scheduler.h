@@ -0,0 +1,123 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_SCHEDULER_H_
+#define CODE_HTTPCLIENT_SCHEDULER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace http {
+
+// Tokens accrue at rate per second up to burst. Take may overdraw, leaving
+// the bucket in debt until enough time has passed; that lets a read that
+// has already happened be charged for in full. A zero rate never runs out.
+class TokenBucket {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  TokenBucket() {}
+  TokenBucket(double rate, double burst) : rate_{rate}, burst_{burst}, tokens_{burst} {}
+
+  bool Limited() const { return rate_ > 0; }
+  double Rate() const { return rate_; }
+  // Tokens on hand as of now, which may be negative.
+  double Available(Clock::time_point now);
+  void Take(double tokens, Clock::time_point now);
+  // How long until there is at least one token.
+  Clock::duration Wait(Clock::time_point now);
+
+ private:
+  void Refill(Clock::time_point now);
+
+  double rate_ = 0;
+  double burst_ = 0;
+  double tokens_ = 0;
+  Clock::time_point last_;
+};
+
+// Rates for Scheduler; zero means no limit. The per-host rates apply to
+// each host:port separately.
+struct Budget {
+  double bytes_per_sec = 0;
+  double requests_per_sec = 0;
+  double host_bytes_per_sec = 0;
+  double host_requests_per_sec = 0;
+};
+
+// Keeps a Fetcher within a Budget (see Fetcher::SetScheduler). A request
+// starts only when a request token is free both globally and for its host.
+// Body bytes are charged as they are read, and a connection whose buckets
+// are in debt stops reading until they recover; through io_uring, whatever
+// the kernel had already received by then is charged as debt. Hosts take
+// turns starting requests, so a long list for one host doesn't starve the
+// others.
+//
+// How many requests run at once adapts as well, between 1 and the
+// Fetcher's own limit. Every kInterval the Scheduler looks at the mean time
+// to first byte and at how much of the budget was used:
+//
+//  - time to first byte above twice the best seen means requests are
+//    queueing at the server or on the way; cut by a quarter.
+//  - budget used in full, and more than half the transfers paused for it:
+//    there are more connections than the budget can feed; drop one.
+//  - otherwise there is room; double while no queueing has been seen,
+//    then add one at a time.
+class Scheduler {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  static constexpr std::chrono::milliseconds kInterval{250};
+
+  explicit Scheduler(const Budget& budget);
+
+  // Takes a request token for host if one is free globally and for host,
+  // and neither owes bytes.
+  bool Admit(const std::string& host, Clock::time_point now);
+  // Whether host may read more body now.
+  bool MayRead(const std::string& host, Clock::time_point now);
+  // How much host may read in one go: what is on hand, but at least
+  // kMinRead so a slow budget doesn't turn into tiny reads.
+  size_t ReadSize(const std::string& host, size_t max, Clock::time_point now);
+  void Consumed(const std::string& host, size_t bytes, Clock::time_point now);
+  // Time until a bucket that has run dry has a token again, at most limit.
+  Clock::duration Wait(Clock::time_point now, Clock::duration limit);
+
+  // Feeds the concurrency control with a finished request, and runs it
+  // once per kInterval given how many transfers are active and paused.
+  void Finished(std::chrono::nanoseconds first_byte);
+  size_t Concurrency(size_t max, size_t active, size_t paused, Clock::time_point now);
+
+  std::string ToString() const;
+
+ private:
+  static constexpr size_t kMinRead = 4096;
+  static constexpr std::chrono::milliseconds kSlack{1};
+
+  struct Host {
+    TokenBucket bytes;
+    TokenBucket requests;
+  };
+
+  Host& For(const std::string& host);
+
+  Budget budget_;
+  TokenBucket bytes_;
+  TokenBucket requests_;
+  std::map<std::string, Host> hosts_;
+
+  size_t limit_ = 0;  // 0 until the first call to Concurrency
+  bool congested_ = false;
+  Clock::time_point window_start_;
+  uint64_t window_bytes_ = 0;
+  uint64_t window_requests_ = 0;
+  std::chrono::nanoseconds window_first_byte_{0};
+  std::chrono::nanoseconds best_first_byte_{0};
+  uint64_t total_bytes_ = 0;
+  uint64_t adjustments_ = 0;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_SCHEDULER_H_
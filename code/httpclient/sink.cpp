@@ -0,0 +1,186 @@
+// Copyright hopkiw 2026
+#include "sink.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace http {
+
+std::string Throughput::ToString() const {
+    std::ostringstream os;
+    os << bytes_ << " bytes in " << std::fixed << std::setprecision(3) << Seconds() << "s ("
+       << std::setprecision(1) << MBps() << " MB/s, " << spliced_ << " spliced";
+    if (decoded_ > 0)
+        os << ", " << Saved() << " saved by compression";
+    os << ")";
+    return os.str();
+}
+
+FileSink::~FileSink() {
+    // A transfer that failed before Finish keeps what did arrive, so a
+    // resumed download picks up where the bytes on disk end.
+    Finish();
+    if (owns_fd_ && fd_ != -1)
+        close(fd_);
+    if (pipe_[0] != -1) {
+        close(pipe_[0]);
+        close(pipe_[1]);
+    }
+}
+
+bool FileSink::Begin(int64_t length) {
+    begun_ = true;
+    start_ = std::chrono::steady_clock::now();
+    buffer_.reserve(kBufferSize);
+    if (!owns_fd_) {
+        if (length != -1 && length != length_) {
+            std::cout << "expected " << length_ << " bytes at offset " << base_ << ", server is sending "
+                      << length << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | (base_ > 0 ? 0 : O_TRUNC), 0644);
+    if (fd_ == -1) {
+        std::cout << "Failed to open " << path_ << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (base_ > 0 && ftruncate(fd_, base_) == -1) {
+        std::cout << "Failed to truncate " << path_ << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    // Not every filesystem supports fallocate; the download works without
+    // it. The blocks are reserved without changing the file size, so the
+    // size of an interrupted download is what actually got written.
+    if (length > 0 && fallocate(fd_, FALLOC_FL_KEEP_SIZE, base_, length) == 0)
+        preallocated_ = base_ + length;
+    return true;
+}
+
+bool FileSink::WriteAt(const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = pwrite(fd_, data, len, offset_);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            std::cout << "Failed to write " << path_ << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        data += n;
+        len -= n;
+        offset_ += n;
+        if (stats_)
+            stats_->Add(n, false);
+    }
+    return true;
+}
+
+bool FileSink::Flush() {
+    if (buffer_.empty())
+        return true;
+    bool ok = WriteAt(buffer_.data(), buffer_.size());
+    buffer_.clear();
+    return ok;
+}
+
+bool FileSink::Write(const char* data, size_t len) {
+    if (!begun_ && !Begin(-1))
+        return false;
+    if (length_ != -1 && Written() + static_cast<int64_t>(len) > length_) {
+        std::cout << "body overruns range at offset " << base_ << std::endl;
+        return false;
+    }
+    if (buffer_.size() + len > kBufferSize && !Flush())
+        return false;
+    if (len >= kBufferSize)
+        return WriteAt(data, len);
+    buffer_.insert(buffer_.end(), data, data + len);
+    return true;
+}
+
+ssize_t FileSink::Splice(int sockfd, size_t len) {
+    if (!Flush())
+        return -1;
+    if (pipe_[0] == -1) {
+        if (pipe2(pipe_, O_CLOEXEC) == -1)
+            return -1;
+        fcntl(pipe_[1], F_SETPIPE_SZ, kPipeSize);
+    }
+
+    if (length_ != -1)
+        len = std::min(len, static_cast<size_t>(length_ - Written()));
+    ssize_t in = splice(sockfd, NULL, pipe_[1], NULL, std::min(len, kPipeSize), SPLICE_F_MOVE | SPLICE_F_MORE);
+    if (in <= 0)
+        return in;
+
+    loff_t off = offset_;
+    for (ssize_t left = in; left > 0; ) {
+        ssize_t out = splice(pipe_[0], NULL, fd_, &off, left, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (out == -1) {
+            if (errno == EINTR)
+                continue;
+            std::cout << "Failed to write " << path_ << ": " << strerror(errno) << std::endl;
+            return -1;
+        }
+        left -= out;
+    }
+    offset_ = off;
+    if (stats_)
+        stats_->Add(in, true);
+    return in;
+}
+
+bool FileSink::Finish() {
+    if (!begun_ || finished_ || fd_ == -1)
+        return true;
+    finished_ = true;
+    bool ok = Flush();
+    std::vector<char>().swap(buffer_);
+    if (!owns_fd_) {
+        if (stats_)
+            stats_->AddTime(std::chrono::steady_clock::now() - start_);
+        return ok;
+    }
+    // A short body must not keep blocks reserved past its end.
+    if (preallocated_ > offset_ && ftruncate(fd_, offset_) == -1)
+        ok = false;
+    close(fd_);
+    fd_ = -1;
+    if (stats_)
+        stats_->AddTime(std::chrono::steady_clock::now() - start_);
+    return ok;
+}
+
+bool MemorySink::Begin(int64_t length) {
+    body_.clear();
+    overflowed_ = false;
+    if (length > static_cast<int64_t>(max_bytes_)) {
+        std::cout << "body of " << length << " bytes is over the limit of " << max_bytes_ << std::endl;
+        overflowed_ = true;
+        return false;
+    }
+    if (length > 0)
+        body_.reserve(length);
+    return true;
+}
+
+bool MemorySink::Write(const char* data, size_t len) {
+    if (len > max_bytes_ - body_.size()) {
+        std::cout << "body is over the limit of " << max_bytes_ << " bytes" << std::endl;
+        overflowed_ = true;
+        return false;
+    }
+    body_.append(data, len);
+    return true;
+}
+
+}  // namespace http
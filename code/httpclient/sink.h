@@ -0,0 +1,175 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_SINK_H_
+#define CODE_HTTPCLIENT_SINK_H_
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace http {
+
+class Response;
+
+// Running totals for body bytes moved into sinks, and how long it took.
+class Throughput {
+ public:
+  void Add(uint64_t bytes, bool spliced) {
+      bytes_ += bytes;
+      if (spliced)
+          spliced_ += bytes;
+  }
+  void AddTime(std::chrono::steady_clock::duration elapsed) { elapsed_ += elapsed; }
+  // A body that arrived as encoded bytes and decoded to decoded bytes.
+  void AddEncoded(uint64_t encoded, uint64_t decoded) {
+      encoded_ += encoded;
+      decoded_ += decoded;
+  }
+  uint64_t Bytes() const { return bytes_; }
+  uint64_t Spliced() const { return spliced_; }
+  // Bytes compression kept off the wire.
+  int64_t Saved() const { return static_cast<int64_t>(decoded_) - static_cast<int64_t>(encoded_); }
+  double Seconds() const { return std::chrono::duration<double>(elapsed_).count(); }
+  double MBps() const { return Seconds() > 0 ? bytes_ / Seconds() / (1024 * 1024) : 0; }
+  std::string ToString() const;
+
+ private:
+  uint64_t bytes_ = 0;
+  uint64_t spliced_ = 0;
+  uint64_t encoded_ = 0;
+  uint64_t decoded_ = 0;
+  std::chrono::steady_clock::duration elapsed_{0};
+};
+
+// Destination for response bodies. ResponseParser calls Begin once the
+// headers are in, then Write for each piece of body, and the Client calls
+// Finish when the response is over.
+class BodySink {
+ public:
+  virtual ~BodySink() {}
+
+  // The response the body belongs to, just before Begin. Sinks that pass
+  // the body on pass this on too.
+  virtual void Head(const Response& res) { (void)res; }
+  // length is the Content-Length, or -1 if the body is chunked or runs
+  // until close.
+  virtual bool Begin(int64_t length) { (void)length; return true; }
+  virtual bool Write(const char* data, size_t len) = 0;
+  virtual bool Finish() { return true; }
+  // Why Begin, Write or Finish failed, where the sink can say more than
+  // that it did.
+  virtual std::string Error() const { return ""; }
+
+  // Sinks backed by a file descriptor can take body bytes straight from
+  // the socket. Splice moves up to len bytes and returns how many it moved,
+  // 0 at end of stream or -1 on error.
+  virtual bool CanSplice() const { return false; }
+  virtual ssize_t Splice(int sockfd, size_t len) { (void)sockfd; (void)len; return -1; }
+};
+
+// Writes a body to a file. Small pieces are gathered into a large buffer so
+// the file sees few, big writes; bulk body data skips userspace entirely by
+// splicing socket -> pipe -> file. When the length is known up front the
+// file is preallocated so the filesystem can lay it out in one go. A sink
+// destroyed without Finish still writes out what it has buffered.
+class FileSink : public BodySink {
+ public:
+  static constexpr size_t kBufferSize = 256 * 1024;
+  static constexpr size_t kPipeSize = 1024 * 1024;
+
+  FileSink(const std::string& path, Throughput* stats) : path_{path}, stats_{stats} {}
+  // Writes into [offset, offset + length) of a file the caller has open,
+  // for one range of a segmented download. The sink doesn't own fd.
+  FileSink(int fd, int64_t offset, int64_t length, Throughput* stats)
+      : stats_{stats}, owns_fd_{false}, fd_{fd}, base_{offset}, offset_{offset}, length_{length} {}
+  FileSink(const FileSink&) = delete;
+  FileSink& operator=(const FileSink&) = delete;
+  ~FileSink();
+
+  bool Begin(int64_t) override;
+  bool Write(const char*, size_t) override;
+  bool Finish() override;
+  bool CanSplice() const override { return fd_ != -1; }
+  ssize_t Splice(int, size_t) override;
+
+  // Keeps the first offset bytes already in the file and writes the body
+  // after them. Call before Begin.
+  void StartAt(int64_t offset) { base_ = offset_ = offset; }
+
+  bool Begun() const { return begun_; }
+  int64_t Written() const { return offset_ + buffer_.size() - base_; }
+
+ private:
+  bool Flush();
+  bool WriteAt(const char*, size_t);
+
+  std::string path_;
+  Throughput* stats_;
+  bool owns_fd_ = true;
+  bool begun_ = false;
+  bool finished_ = false;
+  int fd_ = -1;
+  int pipe_[2] = {-1, -1};
+  int64_t base_ = 0;
+  int64_t offset_ = 0;
+  int64_t length_ = -1;
+  int64_t preallocated_ = 0;
+  std::vector<char> buffer_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Keeps a body in memory. A body longer than max_bytes fails the request
+// instead of growing the buffer without bound.
+class MemorySink : public BodySink {
+ public:
+  static constexpr size_t kDefaultMax = 16 * 1024 * 1024;
+
+  explicit MemorySink(size_t max_bytes = kDefaultMax) : max_bytes_{max_bytes} {}
+
+  bool Begin(int64_t) override;
+  bool Write(const char*, size_t) override;
+
+  const std::string& Body() const { return body_; }
+  std::string Take() { return std::move(body_); }
+  bool Overflowed() const { return overflowed_; }
+
+ private:
+  size_t max_bytes_;
+  bool overflowed_ = false;
+  std::string body_;
+};
+
+// Hands each piece of the body to a function as it arrives. Returning false
+// from it stops the transfer.
+class CallbackSink : public BodySink {
+ public:
+  typedef std::function<bool(const char*, size_t)> Callback;
+
+  explicit CallbackSink(Callback fn) : fn_{fn} {}
+
+  bool Write(const char* data, size_t len) override { return fn_(data, len); }
+
+ private:
+  Callback fn_;
+};
+
+// Counts the body and throws it away.
+class DiscardSink : public BodySink {
+ public:
+  bool Write(const char*, size_t len) override {
+      bytes_ += len;
+      return true;
+  }
+  uint64_t Bytes() const { return bytes_; }
+
+ private:
+  uint64_t bytes_ = 0;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_SINK_H_
@@ -0,0 +1,118 @@
+// Copyright hopkiw 2026
+#include "timing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace http {
+
+namespace {
+
+const char* kPhaseNames[kPhases] = {"dns", "connect", "ttfb", "transfer", "total"};
+
+std::string Millis(uint64_t ns) {
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(3) << ns / 1e6 << "ms";
+    return os.str();
+}
+
+}  // namespace
+
+const char* PhaseName(Phase phase) {
+    return kPhaseNames[phase];
+}
+
+std::string RequestTiming::ToString() const {
+    std::ostringstream os;
+    for (int p = 0; p < kPhases; ++p) {
+        if (p > 0)
+            os << " ";
+        os << kPhaseNames[p] << " " << Millis(phase[p].count());
+    }
+    if (reused)
+        os << " (reused)";
+    return os.str();
+}
+
+// Values below 128 get a bucket each. Above that, a value with its top
+// bit at position m falls in one of 64 buckets covering [2^m, 2^(m+1)),
+// picked by the 6 bits below the top one.
+int Histogram::Index(uint64_t value) {
+    if (value < 128)
+        return value;
+    int m = 63 - __builtin_clzll(value);
+    int shift = m - 6;
+    return 128 + (m - 7) * kSubBuckets + static_cast<int>((value >> shift) - kSubBuckets);
+}
+
+uint64_t Histogram::Lowest(int index) {
+    if (index < 128)
+        return index;
+    int m = (index - 128) / kSubBuckets + 7;
+    uint64_t sub = (index - 128) % kSubBuckets;
+    return (kSubBuckets + sub) << (m - 6);
+}
+
+uint64_t Histogram::Highest(int index) {
+    if (index < 128)
+        return index;
+    int m = (index - 128) / kSubBuckets + 7;
+    return Lowest(index) + ((uint64_t{1} << (m - 6)) - 1);
+}
+
+void Histogram::Record(uint64_t value) {
+    counts_[Index(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::Percentile(double p) const {
+    uint64_t count = Count();
+    if (count == 0)
+        return 0;
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * count)));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= target)
+            return std::min(Highest(i), Max());
+    }
+    return Max();
+}
+
+void Histogram::Clear() {
+    for (auto& count : counts_)
+        count.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+void PhaseHistograms::Record(const RequestTiming& timing) {
+    for (int p = 0; p < kPhases; ++p) {
+        // A reused connection skips DNS and connect; counting those zeros
+        // would hide what new connections cost.
+        if (timing.reused && (p == kResolve || p == kConnect))
+            continue;
+        phases_[p].Record(std::max<int64_t>(0, timing.phase[p].count()));
+    }
+}
+
+std::string PhaseHistograms::ToString() const {
+    std::ostringstream os;
+    os << std::left << std::setw(10) << "phase" << std::right << std::setw(8) << "count" << std::setw(14) << "p50"
+       << std::setw(14) << "p99" << std::setw(14) << "p99.9" << std::setw(14) << "max" << "\n";
+    for (int p = 0; p < kPhases; ++p) {
+        const Histogram& h = phases_[p];
+        os << std::left << std::setw(10) << kPhaseNames[p] << std::right << std::setw(8) << h.Count()
+           << std::setw(14) << Millis(h.Percentile(0.5)) << std::setw(14) << Millis(h.Percentile(0.99))
+           << std::setw(14) << Millis(h.Percentile(0.999)) << std::setw(14) << Millis(h.Max()) << "\n";
+    }
+    return os.str();
+}
+
+}  // namespace http
@@ -0,0 +1,73 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_TIMING_H_
+#define CODE_HTTPCLIENT_TIMING_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace http {
+
+// The phases of one request. FirstByte runs from sending the request to
+// the first byte of the response, Transfer from there to the end of it.
+// Total covers the whole request, connection setup included.
+enum Phase { kResolve, kConnect, kFirstByte, kTransfer, kTotal, kPhases };
+
+const char* PhaseName(Phase);
+
+// Where one request spent its time. Resolve and Connect are zero when the
+// request went out on a pooled connection.
+struct RequestTiming {
+  std::chrono::nanoseconds phase[kPhases] = {};
+  bool reused = false;
+
+  std::string ToString() const;
+};
+
+// Counts values in log-linear buckets in the style of HdrHistogram: exact
+// below 128, then 64 buckets per power of two, so any percentile is within
+// about 1.6% of the true value while the whole range of uint64_t fits in
+// a few thousand counters. Record is a relaxed atomic increment, so
+// threads can share one histogram without a lock.
+class Histogram {
+ public:
+  static constexpr int kSubBuckets = 64;
+  static constexpr int kBuckets = 128 + (64 - 7) * kSubBuckets;
+
+  Histogram() {}
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  void Record(uint64_t);
+  uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+  // The value below which fraction p (0 to 1) of the recorded values lie.
+  uint64_t Percentile(double p) const;
+  void Clear();
+
+ private:
+  static int Index(uint64_t);
+  static uint64_t Lowest(int);
+  static uint64_t Highest(int);
+
+  std::atomic<uint64_t> counts_[kBuckets] = {};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+// One nanosecond histogram per phase.
+class PhaseHistograms {
+ public:
+  void Record(const RequestTiming&);
+  const Histogram& Get(Phase phase) const { return phases_[phase]; }
+  // A table of count, p50, p99, p99.9 and max for each phase.
+  std::string ToString() const;
+
+ private:
+  Histogram phases_[kPhases];
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_TIMING_H_
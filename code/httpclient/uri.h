@@ -0,0 +1,300 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_URI_H_
+#define CODE_HTTPCLIENT_URI_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace http {
+
+// The parts of a URI as views into the string it was parsed from, so
+// parsing allocates nothing and can run at compile time. Delimiters are
+// left out: query has no '?', fragment no '#' and an IPv6 host no
+// brackets.
+struct URIView {
+  std::string_view scheme, userinfo, host, port, path, query, fragment;
+  bool has_query = false;
+  bool has_fragment = false;
+  bool ipv6 = false;
+
+  // The port as a number, or the scheme's default when the URI doesn't
+  // give one; 0 if neither is known.
+  constexpr uint16_t PortNumber() const;
+};
+
+namespace internal {
+
+constexpr bool IsAlpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+constexpr bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+constexpr int HexValue(char c) {
+    if (IsDigit(c))
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+constexpr bool SchemeIs(std::string_view scheme, std::string_view lower) {
+    if (scheme.length() != lower.length())
+        return false;
+    for (size_t i = 0; i < scheme.length(); ++i) {
+        char c = scheme[i] >= 'A' && scheme[i] <= 'Z' ? scheme[i] - 'A' + 'a' : scheme[i];
+        if (c != lower[i])
+            return false;
+    }
+    return true;
+}
+
+// scheme = ALPHA *( ALPHA / DIGIT / "+" / "-" / "." )
+constexpr bool ValidScheme(std::string_view scheme) {
+    if (scheme.empty() || !IsAlpha(scheme[0]))
+        return false;
+    for (char c : scheme) {
+        if (!IsAlpha(c) && !IsDigit(c) && c != '+' && c != '-' && c != '.')
+            return false;
+    }
+    return true;
+}
+
+// Hex digits, colons and dots (for an embedded IPv4 address), plus an
+// optional %zone. Enough to keep stray brackets and the like out; the
+// resolver has the last word.
+constexpr bool ValidIPv6(std::string_view host) {
+    if (host.find(':') == std::string_view::npos)
+        return false;
+    size_t zone = host.find('%');
+    for (char c : host.substr(0, zone)) {
+        if (HexValue(c) == -1 && c != ':' && c != '.')
+            return false;
+    }
+    return zone != host.length() - 1;
+}
+
+// Up to five digits, no more than 65535.
+constexpr bool ValidPort(std::string_view port) {
+    if (port.length() > 5)
+        return false;
+    uint32_t value = 0;
+    for (char c : port) {
+        if (!IsDigit(c))
+            return false;
+        value = value * 10 + (c - '0');
+    }
+    return value <= 65535;
+}
+
+}  // namespace internal
+
+constexpr uint16_t URIView::PortNumber() const {
+    if (port.empty()) {
+        if (internal::SchemeIs(scheme, "http") || internal::SchemeIs(scheme, "ws") || scheme.empty())
+            return 80;
+        if (internal::SchemeIs(scheme, "https") || internal::SchemeIs(scheme, "wss"))
+            return 443;
+        return 0;
+    }
+    uint32_t value = 0;
+    for (char c : port)
+        value = value * 10 + (c - '0');
+    return static_cast<uint16_t>(value);
+}
+
+// Splits uri into its parts (RFC 3986 section 3):
+//
+//   scheme://userinfo@host:port/path?query#fragment
+//
+// Everything but the host may be missing; without a scheme the URI starts
+// at the authority, as in "example.com/path". Returns false for a bad
+// scheme, port or bracketed IPv6 host, in which case out is unspecified.
+// Nothing is percent-decoded; see PercentDecode.
+constexpr bool ParseURI(std::string_view uri, URIView* out) {
+    constexpr size_t npos = std::string_view::npos;
+    *out = URIView();
+
+    size_t hash = uri.find('#');
+    if (hash != npos) {
+        out->fragment = uri.substr(hash + 1);
+        out->has_fragment = true;
+        uri = uri.substr(0, hash);
+    }
+    size_t question = uri.find('?');
+    if (question != npos) {
+        out->query = uri.substr(question + 1);
+        out->has_query = true;
+        uri = uri.substr(0, question);
+    }
+
+    // A colon after the first slash is part of the path.
+    size_t colon = uri.find(':');
+    if (colon != npos && colon < uri.find('/') && uri.substr(colon, 3) == "://") {
+        if (!internal::ValidScheme(uri.substr(0, colon)))
+            return false;
+        out->scheme = uri.substr(0, colon);
+        uri.remove_prefix(colon + 3);
+    } else if (uri.substr(0, 2) == "//") {
+        uri.remove_prefix(2);
+    }
+
+    size_t slash = uri.find('/');
+    std::string_view authority = uri.substr(0, slash);
+    if (slash != npos)
+        out->path = uri.substr(slash);
+
+    size_t at = authority.rfind('@');
+    if (at != npos) {
+        out->userinfo = authority.substr(0, at);
+        authority.remove_prefix(at + 1);
+    }
+
+    if (!authority.empty() && authority[0] == '[') {
+        size_t close = authority.find(']');
+        if (close == npos)
+            return false;
+        out->host = authority.substr(1, close - 1);
+        out->ipv6 = true;
+        if (!internal::ValidIPv6(out->host))
+            return false;
+        authority.remove_prefix(close + 1);
+        if (!authority.empty() && authority[0] != ':')
+            return false;
+        if (!authority.empty())
+            out->port = authority.substr(1);
+    } else {
+        size_t port = authority.find(':');
+        out->host = authority.substr(0, port);
+        if (port != npos)
+            out->port = authority.substr(port + 1);
+    }
+    return internal::ValidPort(out->port);
+}
+
+// Decodes the %XX escapes in in, writing to out, which needs room for
+// in.length() chars. Returns the decoded length, or npos if an escape is
+// cut short or isn't hex. '+' is left alone; it only means a space in
+// form data.
+constexpr size_t PercentDecode(std::string_view in, char* out) {
+    size_t n = 0;
+    for (size_t i = 0; i < in.length(); ++i) {
+        if (in[i] != '%') {
+            out[n++] = in[i];
+            continue;
+        }
+        if (i + 2 >= in.length())
+            return std::string_view::npos;
+        int high = internal::HexValue(in[i + 1]);
+        int low = internal::HexValue(in[i + 2]);
+        if (high == -1 || low == -1)
+            return std::string_view::npos;
+        out[n++] = static_cast<char>(high * 16 + low);
+        i += 2;
+    }
+    return n;
+}
+
+inline bool PercentDecode(std::string_view in, std::string* out) {
+    out->resize(in.length());
+    size_t n = PercentDecode(in, &(*out)[0]);
+    if (n == std::string_view::npos)
+        return false;
+    out->resize(n);
+    return true;
+}
+
+namespace internal {
+
+// Drops "." and ".." segments from an absolute path (RFC 3986 section
+// 5.2.4). ".." never climbs above the root.
+inline std::string RemoveDotSegments(std::string_view path) {
+    std::string out;
+    while (!path.empty()) {
+        size_t end = path.find('/', 1);
+        std::string_view segment = path.substr(0, end);
+        path.remove_prefix(segment.length());
+        if (segment == "/." || segment == "/..") {
+            if (segment == "/..")
+                out.erase(std::min(out.length(), out.rfind('/')));
+            // The last segment leaves the path ending in a slash.
+            if (path.empty())
+                out += '/';
+        } else {
+            out.append(segment);
+        }
+    }
+    return out;
+}
+
+}  // namespace internal
+
+// A parsed URI that owns its parts. QueryString keeps its leading '?' so
+// Path + QueryString is the request target; Host has no brackets.
+class URI {
+ public:
+  std::string QueryString, Path, Protocol, Host, Port, UserInfo, Fragment;
+
+  // What the reference ref (a Location header, say) points to, taking this
+  // URI as the base (RFC 3986 section 5.2). An empty URI if ref doesn't
+  // parse or has a scheme other than "scheme://".
+  URI Resolve(std::string_view ref) const {
+    size_t colon = ref.find(':');
+    if (colon != std::string_view::npos && colon < ref.find_first_of("/?#") &&
+        internal::ValidScheme(ref.substr(0, colon)))
+        return ref.substr(colon, 3) == "://" ? Parse(ref) : URI();
+    if (ref.substr(0, 2) == "//") {
+        URI result = Parse(ref);
+        if (!result.Host.empty())
+            result.Protocol = Protocol;
+        return result;
+    }
+
+    URI result = *this;
+    size_t hash = ref.find('#');
+    result.Fragment.assign(hash == std::string_view::npos ? std::string_view() : ref.substr(hash + 1));
+    ref = ref.substr(0, hash);
+    size_t question = ref.find('?');
+    std::string_view path = ref.substr(0, question);
+    if (question != std::string_view::npos)
+        result.QueryString.assign(ref.substr(question));
+    else if (!path.empty())
+        result.QueryString.clear();
+
+    if (path.empty())
+        return result;
+    if (path[0] == '/') {
+        result.Path = internal::RemoveDotSegments(path);
+    } else {
+        // Relative to the base's directory.
+        size_t slash = Path.rfind('/');
+        std::string merged = slash == std::string::npos ? "/" : Path.substr(0, slash + 1);
+        merged.append(path);
+        result.Path = internal::RemoveDotSegments(merged);
+    }
+    return result;
+  }
+
+  // An empty URI (no Host) if uri doesn't parse.
+  static URI Parse(std::string_view uri) {
+    URI result;
+    URIView view;
+    if (!ParseURI(uri, &view))
+        return result;
+    result.Protocol.assign(view.scheme);
+    result.UserInfo.assign(view.userinfo);
+    result.Host.assign(view.host);
+    result.Port.assign(view.port);
+    result.Path.assign(view.path);
+    if (view.has_query)
+        result.QueryString.append("?").append(view.query);
+    result.Fragment.assign(view.fragment);
+    return result;
+  }
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_URI_H_
@@ -0,0 +1,221 @@
+// Copyright hopkiw 2026
+#include "uring.h"
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace http {
+
+namespace {
+
+int Setup(unsigned entries, struct io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int Enter(int fd, unsigned submit, unsigned wait, unsigned flags, void* arg, size_t arg_size) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, wait, flags, arg, arg_size));
+}
+
+int Register(int fd, unsigned op, void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, op, arg, count));
+}
+
+// The rings are shared with the kernel: read what it writes with acquire,
+// publish what we write with release.
+template <typename T>
+T LoadAcquire(const T* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+
+template <typename T>
+void StoreRelease(T* p, T value) { __atomic_store_n(p, value, __ATOMIC_RELEASE); }
+
+}  // namespace
+
+Uring::~Uring() {
+    if (buf_ring_ != nullptr)
+        munmap(buf_ring_, buf_ring_size_);
+    if (sqes_ != nullptr)
+        munmap(sqes_, sqes_size_);
+    if (ring_ != nullptr)
+        munmap(ring_, ring_size_);
+    if (fd_ != -1)
+        close(fd_);
+}
+
+bool Uring::Init(unsigned entries, unsigned buffers, size_t buffer_size) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    // Multishot receives can post many completions per submission.
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+    params.cq_entries = entries * 4;
+    int fd = Setup(entries, &params);
+    if (fd == -1)
+        return false;
+    const unsigned kNeeded = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ((params.features & kNeeded) != kNeeded) {
+        close(fd);
+        return false;
+    }
+    fd_ = fd;
+
+    ring_size_ = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                          params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe));
+    ring_ = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (ring_ == MAP_FAILED || sqes == MAP_FAILED) {
+        if (ring_ == MAP_FAILED)
+            ring_ = nullptr;
+        if (sqes != MAP_FAILED)
+            munmap(sqes, sqes_size_);
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+    char* base = static_cast<char*>(ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    tail_ = *sq_tail_;
+    // Slot i of the ring always holds SQE i.
+    unsigned* array = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+    for (unsigned i = 0; i < sq_entries_; ++i)
+        array[i] = i;
+    cq_head_ = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(base + params.cq_off.cqes);
+
+    buf_ring_size_ = buffers * sizeof(struct io_uring_buf);
+    void* buf_ring = mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf_ring == MAP_FAILED) {
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    buf_ring_ = static_cast<struct io_uring_buf_ring*>(buf_ring);
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+    reg.ring_entries = buffers;
+    reg.bgid = kBufferGroup;
+    if (Register(fd_, IORING_REGISTER_PBUF_RING, &reg, 1) == -1) {
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    buf_mask_ = buffers - 1;
+    buffer_size_ = buffer_size;
+    buffers_.resize(buffers * buffer_size);
+    for (unsigned i = 0; i < buffers; ++i)
+        Provide(i);
+    return true;
+}
+
+// A cleared SQE at the tail of the submission ring, submitting what's
+// queued first if the ring is full.
+struct io_uring_sqe* Uring::Next() {
+    if (tail_ - LoadAcquire(sq_head_) >= sq_entries_)
+        Submit(0, 0, nullptr, 0);
+    struct io_uring_sqe* sqe = &sqes_[tail_ & sq_mask_];
+    memset(sqe, 0, sizeof(*sqe));
+    ++tail_;
+    return sqe;
+}
+
+bool Uring::Submit(unsigned wait, unsigned flags, void* arg, size_t arg_size) {
+    StoreRelease(sq_tail_, tail_);
+    unsigned queued = tail_ - LoadAcquire(sq_head_);
+    int ret = Enter(fd_, queued, wait, flags, arg, arg_size);
+    return ret != -1 || errno == ETIME || errno == EINTR;
+}
+
+void Uring::PollOut(int fd, uint64_t data) {
+    struct io_uring_sqe* sqe = Next();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = POLLOUT;
+    sqe->user_data = data;
+}
+
+void Uring::SendMsg(int fd, const struct msghdr* msg, uint64_t data) {
+    struct io_uring_sqe* sqe = Next();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(msg);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = data;
+}
+
+void Uring::RecvMultishot(int fd, uint64_t data) {
+    struct io_uring_sqe* sqe = Next();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    sqe->user_data = data;
+}
+
+void Uring::Cancel(uint64_t data) {
+    struct io_uring_sqe* sqe = Next();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = data;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data = 0;
+}
+
+bool Uring::Wait(std::chrono::milliseconds timeout) {
+    struct __kernel_timespec ts;
+    ts.tv_sec = timeout.count() / 1000;
+    ts.tv_nsec = (timeout.count() % 1000) * 1000000;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+    return Submit(1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+}
+
+bool Uring::Pop(struct io_uring_cqe* cqe) {
+    // Cancel's own completions are of no interest.
+    while (true) {
+        unsigned head = *cq_head_;
+        if (head == LoadAcquire(cq_tail_))
+            return false;
+        *cqe = cqes_[head & cq_mask_];
+        StoreRelease(cq_head_, head + 1);
+        if (cqe->user_data != 0)
+            return true;
+    }
+}
+
+const char* Uring::Buffer(const struct io_uring_cqe& cqe) const {
+    return buffers_.data() + (cqe.flags >> IORING_CQE_BUFFER_SHIFT) * buffer_size_;
+}
+
+void Uring::Recycle(const struct io_uring_cqe& cqe) {
+    if (cqe.flags & IORING_CQE_F_BUFFER)
+        Provide(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+}
+
+void Uring::Provide(uint16_t id) {
+    // Not buf_ring_->bufs: compiled as C++, the header's flexible array
+    // member lands 8 bytes past where the kernel looks.
+    struct io_uring_buf* buf = reinterpret_cast<struct io_uring_buf*>(buf_ring_) + (buf_tail_ & buf_mask_);
+    buf->addr = reinterpret_cast<uint64_t>(buffers_.data() + id * buffer_size_);
+    buf->len = buffer_size_;
+    buf->bid = id;
+    ++buf_tail_;
+    StoreRelease(&buf_ring_->tail, buf_tail_);
+}
+
+}  // namespace http
@@ -0,0 +1,87 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_URING_H_
+#define CODE_HTTPCLIENT_URING_H_
+
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace http {
+
+// Just enough io_uring for the Fetcher, on the raw system calls. Operations
+// are queued in the submission ring and go to the kernel together in Wait,
+// one io_uring_enter per batch. Receives take their buffers from a ring of
+// buffers registered with the kernel up front, so one multishot recv per
+// socket keeps delivering data without being resubmitted.
+//
+// Needs Linux 6.0 or later; Init fails on older kernels so the caller can
+// fall back to epoll.
+class Uring {
+ public:
+  Uring() {}
+  Uring(const Uring&) = delete;
+  Uring& operator=(const Uring&) = delete;
+  ~Uring();
+
+  // A ring with room for entries queued operations, and buffers receive
+  // buffers of buffer_size bytes each; buffers must be a power of two.
+  bool Init(unsigned entries, unsigned buffers, size_t buffer_size);
+  bool Ready() const { return fd_ != -1; }
+
+  // Queue an operation; data comes back in its completion. The msghdr must
+  // stay put until SendMsg completes.
+  void PollOut(int fd, uint64_t data);
+  void SendMsg(int fd, const struct msghdr*, uint64_t data);
+  void RecvMultishot(int fd, uint64_t data);
+  // Cancels the operations queued with data. Its own completion is
+  // dropped.
+  void Cancel(uint64_t data);
+
+  // Submits whatever is queued and waits up to timeout for a completion.
+  // Returns false on error.
+  bool Wait(std::chrono::milliseconds timeout);
+  // Takes the next completion, if there is one.
+  bool Pop(struct io_uring_cqe*);
+
+  // The receive buffer a completion filled, and handing it back once the
+  // data has been used.
+  const char* Buffer(const struct io_uring_cqe&) const;
+  void Recycle(const struct io_uring_cqe&);
+
+ private:
+  static constexpr uint16_t kBufferGroup = 0;
+
+  struct io_uring_sqe* Next();
+  bool Submit(unsigned wait, unsigned flags, void* arg, size_t arg_size);
+  void Provide(uint16_t);
+
+  int fd_ = -1;
+  void* ring_ = nullptr;
+  size_t ring_size_ = 0;
+  struct io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  unsigned tail_ = 0;  // ours; the kernel sees it at the next Submit
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  struct io_uring_cqe* cqes_ = nullptr;
+
+  struct io_uring_buf_ring* buf_ring_ = nullptr;
+  size_t buf_ring_size_ = 0;
+  uint16_t buf_tail_ = 0;
+  unsigned buf_mask_ = 0;
+  size_t buffer_size_ = 0;
+  std::vector<char> buffers_;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_URING_H_
@@ -0,0 +1,82 @@
+// Copyright hopkiw 2026
+#include "writer.h"
+
+#include <limits.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace http {
+
+void RequestWriter::Add(const Request& request) {
+    size_t start = pieces_.size();
+    request.Serialize(&pieces_);
+    for (size_t i = start; i < pieces_.size(); ++i) {
+        iov_.push_back(pieces_[i]);
+        total_ += pieces_[i].iov_len;
+        pending_ += pieces_[i].iov_len;
+    }
+}
+
+void RequestWriter::Add(std::string_view data) {
+    if (data.empty())
+        return;
+    pieces_.push_back(iovec{const_cast<char*>(data.data()), data.length()});
+    iov_.push_back(pieces_.back());
+    total_ += data.length();
+    pending_ += data.length();
+}
+
+bool RequestWriter::Flush(int fd) {
+    while (pending_ > 0) {
+        // sendmsg rather than writev, for MSG_NOSIGNAL.
+        struct msghdr msg;
+        Prepare(&msg);
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        Advance(n);
+    }
+    return true;
+}
+
+void RequestWriter::Prepare(struct msghdr* msg) {
+    memset(msg, 0, sizeof(*msg));
+    msg->msg_iov = &iov_[first_];
+    msg->msg_iovlen = std::min<size_t>(iov_.size() - first_, IOV_MAX);
+}
+
+// Drops the pieces that went out in full and trims the one that went out
+// in part.
+void RequestWriter::Advance(size_t n) {
+    pending_ -= n;
+    while (n > 0 && n >= iov_[first_].iov_len) {
+        n -= iov_[first_].iov_len;
+        ++first_;
+    }
+    if (n > 0) {
+        iov_[first_].iov_base = static_cast<char*>(iov_[first_].iov_base) + n;
+        iov_[first_].iov_len -= n;
+    }
+}
+
+void RequestWriter::Rewind() {
+    iov_ = pieces_;
+    first_ = 0;
+    pending_ = total_;
+}
+
+void RequestWriter::Clear() {
+    pieces_.clear();
+    iov_.clear();
+    first_ = 0;
+    total_ = 0;
+    pending_ = 0;
+}
+
+}  // namespace http
@@ -0,0 +1,55 @@
+// Copyright hopkiw 2026
+#ifndef CODE_HTTPCLIENT_WRITER_H_
+#define CODE_HTTPCLIENT_WRITER_H_
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "message.h"
+
+namespace http {
+
+// Sends one or more requests with as few writev calls as the socket
+// allows. The requests aren't copied: each Add records pieces pointing
+// into the Request, which must stay alive and unchanged until the writer
+// is done with it. Several requests added before a Flush go out together,
+// which is how pipelined requests share a syscall.
+class RequestWriter {
+ public:
+  void Add(const Request&);
+  // Raw bytes, such as a piece of a chunked body; not copied either.
+  void Add(std::string_view data);
+
+  // Writes what's left. Returns false on a socket error. On a non-blocking
+  // socket that fills up it returns true with Done() still false; call it
+  // again once the socket is writable.
+  bool Flush(int fd);
+
+  // For sending some other way, such as through io_uring: points msg at
+  // what's left, and drops n bytes once they have gone out.
+  void Prepare(struct msghdr* msg);
+  void Advance(size_t n);
+
+  bool Done() const { return pending_ == 0; }
+  size_t Pending() const { return pending_; }
+  size_t Sent() const { return total_ - pending_; }
+
+  // Starts over from the first byte, for resending on a new connection.
+  void Rewind();
+  void Clear();
+
+ private:
+  std::vector<struct iovec> pieces_;  // as added
+  std::vector<struct iovec> iov_;     // what's left to send
+  size_t first_ = 0;
+  size_t total_ = 0;
+  size_t pending_ = 0;
+};
+
+}  // namespace http
+
+#endif  // CODE_HTTPCLIENT_WRITER_H_
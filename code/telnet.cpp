@@ -46,8 +46,9 @@ int main(int argc, char** argv) {
 
     fd_set reads, writes;
 
-    char buf[1024];
-    int recv_bytes = 0;
+    // Not cleared between reads; only the first recv_bytes are printed.
+    static char buf[64 * 1024];
+    ssize_t recv_bytes = 0;
     std::string msg;
 
     std::cout << "Connected. 'quit' to quit" << std::endl;
@@ -69,7 +70,7 @@ int main(int argc, char** argv) {
 
         if (recv_bytes != 0) {
             if (FD_ISSET(STDOUT_FILENO, &writes)) {
-                std::cout << buf << std::endl;
+                std::cout.write(buf, recv_bytes) << std::endl;
                 recv_bytes = 0;
             }
         }
@@ -84,9 +85,7 @@ int main(int argc, char** argv) {
         }
 
         if (FD_ISSET(sockfd, &reads)) {
-            memset(buf, 0, 1024);
-
-            recv_bytes = recv(sockfd, buf, 1024, 0);
+            recv_bytes = recv(sockfd, buf, sizeof(buf), 0);
             if (recv_bytes == -1) {
                 std::cout << "Failed to send message: " << std::endl;
                 return 1;